@@ -0,0 +1,73 @@
+#!/usr/bin/env python
+# PYTHON_ARGCOMPLETE_OK
+
+import sys
+import jack
+import time
+import argparse
+
+def run(source_server, target_server, channels, latency):
+
+    source_client = jack.Client('bridge', server_name = source_server)
+    target_client = jack.Client('bridge', server_name = target_server)
+
+    bridges = []
+    for channel in range(channels):
+        source_port = source_client.register_port(
+                name = 'in_%d' % (channel + 1),
+                type = jack.DefaultAudioPortType,
+                direction = jack.Input,
+                )
+        target_port = target_client.register_port(
+                name = 'out_%d' % (channel + 1),
+                type = jack.DefaultAudioPortType,
+                direction = jack.Output,
+                )
+        bridges.append(jack.Bridge(
+                source_client, source_port,
+                target_client, target_port,
+                latency = latency,
+                ))
+
+    source_client.activate()
+    target_client.activate()
+
+    while True:
+        try:
+            time.sleep(1)
+        except KeyboardInterrupt:
+            break
+        for bridge in bridges:
+            print('fill %d/%d, ratio %.6f, %d underruns, %d overruns' % (
+                bridge.get_fill(),
+                bridge.get_latency(),
+                bridge.get_ratio(),
+                bridge.get_underruns(),
+                bridge.get_overruns(),
+                ))
+
+def _init_argparser():
+
+    argparser = argparse.ArgumentParser(description = 'Move audio from one JACK server to another.')
+    argparser.add_argument('source_server')
+    argparser.add_argument('target_server')
+    argparser.add_argument('--channels', type = int, default = 2)
+    argparser.add_argument('--latency', type = int, default = 0, help = 'average number of buffered samples (default: three periods)')
+    return argparser
+
+def main(argv):
+
+    argparser = _init_argparser()
+    try:
+        import argcomplete
+        argcomplete.autocomplete(argparser)
+    except ImportError:
+        pass
+    args = argparser.parse_args(argv)
+
+    run(**vars(args))
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
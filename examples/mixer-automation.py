@@ -0,0 +1,57 @@
+#!/usr/bin/env python
+# PYTHON_ARGCOMPLETE_OK
+
+import sys
+import jack
+import time
+import argparse
+
+def run(channels, period):
+
+    client = jack.Client('mixer automation example')
+    inputs = [client.register_port('in_%d' % (index + 1), jack.DefaultAudioPortType, jack.Input)
+                for index in range(channels)]
+    outputs = [client.register_port('out_%d' % (index + 1), jack.DefaultAudioPortType, jack.Output)
+                for index in range(channels)]
+    mixer = jack.Mixer(client, inputs, outputs)
+    client.activate()
+
+    print('client name: ' + client.get_name())
+
+    # Fade all channels out and in again, scheduled one second ahead.
+    sample_rate = client.get_sample_rate()
+    fade = int(sample_rate * period / 4)
+    frame = client.get_frame_time() + sample_rate
+    while True:
+        for output in range(channels):
+            mixer.set_gain(output, 0.0, frame = frame, ramp = jack.RampCosine, duration = fade)
+            mixer.set_gain(output, 1.0, frame = frame + 2 * fade, ramp = jack.RampCosine, duration = fade)
+        frame += 4 * fade
+        try:
+            time.sleep(period)
+        except KeyboardInterrupt:
+            break
+
+def _init_argparser():
+
+    argparser = argparse.ArgumentParser(description = None)
+    argparser.add_argument('--channels', type = int, default = 2)
+    argparser.add_argument('--period', type = float, default = 2.0, help = 'seconds')
+    return argparser
+
+def main(argv):
+
+    argparser = _init_argparser()
+    try:
+        import argcomplete
+        argcomplete.autocomplete(argparser)
+    except ImportError:
+        pass
+    args = argparser.parse_args(argv)
+
+    run(**vars(args))
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,84 @@
+#!/usr/bin/env python
+# PYTHON_ARGCOMPLETE_OK
+
+# Print peak levels of a jack.SharedMemoryTap exported by another process.
+# Usage: shared-memory-reader.py <pid> <fd>
+
+import sys
+import math
+import mmap
+import time
+import array
+import struct
+import argparse
+
+header_format = '=IIIIQQQQ'
+position_offset = 40
+
+def read_header(memory):
+    return struct.unpack_from(header_format, memory)
+
+def read_position(memory):
+    return struct.unpack_from('=Q', memory, position_offset)[0]
+
+def read_channel(memory, header, channel, start, stop):
+    capacity, data_offset = header[4:6]
+    channel_offset = data_offset + channel * capacity * 4
+    samples = array.array('f')
+    # One slice per contiguous range, the second one after wrapping around.
+    while start < stop:
+        index = start % capacity
+        count = min(stop - start, capacity - index)
+        samples.fromstring(memory[channel_offset + index * 4:channel_offset + (index + count) * 4])
+        start += count
+    return samples
+
+def run(pid, fd):
+
+    with open('/proc/%d/fd/%d' % (pid, fd), 'rb') as shared_memory_file:
+        memory = mmap.mmap(shared_memory_file.fileno(), 0, mmap.MAP_SHARED, mmap.PROT_READ)
+
+    header = read_header(memory)
+    channel_count = header[2]
+    capacity = header[4]
+    position = header[7]
+    while True:
+        try:
+            time.sleep(0.1)
+        except KeyboardInterrupt:
+            break
+        while True:
+            latest = read_position(memory)
+            start = max(position, latest - capacity // 4)
+            channels = [read_channel(memory, header, channel, start, latest) for channel in range(channel_count)]
+            # The capacity covers at least two periods, so samples from start on can only
+            # have been overwritten if the position advanced by more than a quarter meanwhile.
+            if read_position(memory) - latest <= capacity // 4:
+                break
+        peaks = [max([abs(s) for s in samples] or [0]) for samples in channels]
+        position = latest
+        print(' '.join(['%6.1f dB' % (20 * math.log10(peak)) if peak else '  -inf dB' for peak in peaks]))
+
+def _init_argparser():
+
+    argparser = argparse.ArgumentParser(description = None)
+    argparser.add_argument('pid', type = int)
+    argparser.add_argument('fd', type = int)
+    return argparser
+
+def main(argv):
+
+    argparser = _init_argparser()
+    try:
+        import argcomplete
+        argcomplete.autocomplete(argparser)
+    except ImportError:
+        pass
+    args = argparser.parse_args(argv)
+
+    run(**vars(args))
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
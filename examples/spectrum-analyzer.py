@@ -0,0 +1,63 @@
+#!/usr/bin/env python
+# PYTHON_ARGCOMPLETE_OK
+
+import sys
+import jack
+import math
+import time
+import argparse
+
+def run(size, overlap, bands):
+
+    client = jack.Client('spectrum analyzer')
+    port = client.register_port(
+            name = 'in',
+            type = jack.DefaultAudioPortType,
+            direction = jack.Input,
+            )
+    analyzer = jack.SpectrumAnalyzer(client, port, size = size, overlap = overlap)
+    client.activate()
+
+    print('client name: ' + client.get_name())
+
+    while True:
+        try:
+            time.sleep(0.1)
+        except KeyboardInterrupt:
+            break
+        spectrum = analyzer.get_spectrum()
+        if spectrum is None:
+            continue
+        # logarithmically spaced bands
+        levels = []
+        for band in range(bands):
+            start = int(len(spectrum) ** (float(band) / bands))
+            stop = max(start + 1, int(len(spectrum) ** (float(band + 1) / bands)))
+            peak = max(spectrum[start:stop])
+            levels.append(20 * math.log10(peak) if peak > 0 else -120)
+        print(' '.join(['%4d' % level for level in levels]))
+
+def _init_argparser():
+
+    argparser = argparse.ArgumentParser(description = None)
+    argparser.add_argument('--size', type = int, default = 4096)
+    argparser.add_argument('--overlap', type = float, default = 0.5)
+    argparser.add_argument('--bands', type = int, default = 16)
+    return argparser
+
+def main(argv):
+
+    argparser = _init_argparser()
+    try:
+        import argcomplete
+        argcomplete.autocomplete(argparser)
+    except ImportError:
+        pass
+    args = argparser.parse_args(argv)
+
+    run(**vars(args))
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
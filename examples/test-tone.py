@@ -0,0 +1,57 @@
+#!/usr/bin/env python
+# PYTHON_ARGCOMPLETE_OK
+
+import sys
+import jack
+import time
+import argparse
+
+def run(frequency, amplitude, sweep):
+
+    client = jack.Client('test tone')
+    port = client.register_port(
+            name = 'out',
+            type = jack.DefaultAudioPortType,
+            direction = jack.Output,
+            )
+    oscillator = jack.Oscillator(client, port, frequency = frequency, amplitude = amplitude)
+    client.activate()
+
+    print('client name: ' + client.get_name())
+
+    while True:
+        try:
+            time.sleep(0.1)
+        except KeyboardInterrupt:
+            break
+        if sweep:
+            # one octave per second, wrapping around at 16 kHz
+            frequency = frequency * 2 ** 0.1
+            if frequency > 16000:
+                frequency = 20
+            oscillator.set_frequency(frequency)
+
+def _init_argparser():
+
+    argparser = argparse.ArgumentParser(description = None)
+    argparser.add_argument('--frequency', type = float, default = 1000)
+    argparser.add_argument('--amplitude', type = float, default = 0.1)
+    argparser.add_argument('--sweep', action = 'store_true')
+    return argparser
+
+def main(argv):
+
+    argparser = _init_argparser()
+    try:
+        import argcomplete
+        argcomplete.autocomplete(argparser)
+    except ImportError:
+        pass
+    args = argparser.parse_args(argv)
+
+    run(**vars(args))
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,57 @@
+#!/usr/bin/env python
+# PYTHON_ARGCOMPLETE_OK
+
+# Record a timeline viewable in chrome://tracing or https://ui.perfetto.dev
+
+import sys
+import jack
+import time
+import argparse
+
+def port_registered(client, port):
+    print('registered port %s' % port.get_name())
+
+def run(duration, output_path):
+
+    jack.start_tracing()
+
+    client = jack.Client('trace example')
+    client.set_port_registered_callback(port_registered)
+    port = client.register_port('in', jack.DefaultAudioPortType, jack.Input)
+    analyzer = jack.SpectrumAnalyzer(client, port)
+    client.activate()
+
+    print('client name: ' + client.get_name())
+
+    try:
+        time.sleep(duration)
+    except KeyboardInterrupt:
+        pass
+
+    jack.stop_tracing()
+    jack.dump_trace(output_path)
+    print('trace written to %s' % output_path)
+
+def _init_argparser():
+
+    argparser = argparse.ArgumentParser(description = None)
+    argparser.add_argument('--duration', type = float, default = 5.0, help = 'seconds')
+    argparser.add_argument('output_path')
+    return argparser
+
+def main(argv):
+
+    argparser = _init_argparser()
+    try:
+        import argcomplete
+        argcomplete.autocomplete(argparser)
+    except ImportError:
+        pass
+    args = argparser.parse_args(argv)
+
+    run(**vars(args))
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -1,14 +1,107 @@
 #include <python2.7/Python.h>
 
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdint.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
 #include <jack/jack.h>
+#include <jack/ringbuffer.h>
+#include <jack/thread.h>
+// Futexes, memfd and huge pages, with fallbacks on other systems.
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 
 const int port_input = 1;
 const int port_output = 2;
 
+// Returns the object containing the given member.
+#define container_of(pointer, type, member) ((type*)((char*)(pointer) - offsetof(type, member)))
+
+// Unit of work run in the JACK process thread once per cycle.
+// Implementations must not allocate, block or call the Python API.
+typedef struct processor {
+    void (*process)(struct processor* self, jack_nframes_t nframes);
+    // Static string, e.g. for tracing
+    const char* name;
+} processor;
+
+// Never modified once published to the process thread, replaced as a whole instead.
+typedef struct {
+    size_t count;
+    processor* items[];
+} processor_list;
+
+// Threads sharing the processors of a cycle with the process thread.
+// Replaced as a whole when the number of threads changes.
+typedef struct {
+    jack_client_t* client;
+    jack_native_thread_t* threads;
+    size_t thread_count;
+    // Futex word, incremented by the process thread to start a cycle.
+    int generation;
+    int sleeping;
+    int stopping;
+    // Generation in the upper, number of unclaimed processors in the lower 32 bits.
+    // Workers still busy with a previous generation can therefore never claim processors of the next one.
+    uint64_t claim;
+    // Futex word the process thread waits on until all processors of the cycle finished.
+    int finished;
+    int joining;
+    unsigned int count;
+    processor** processors;
+    jack_nframes_t nframes;
+    // Remaining cycles run by the process thread alone after workers were late.
+    unsigned int serial_cycles;
+} worker_pool;
+
+// Header in front of each block of an arena, padded to the arena alignment.
+typedef struct arena_block {
+    // Including the header.
+    size_t size;
+    // Next free block by address, for free blocks only.
+    struct arena_block* next;
+} arena_block;
+
+// Memory for buffers used in the process thread, mapped once per client.
+// Only pages of allocated blocks are faulted in, and locked once the client was activated.
+typedef struct {
+    char* base;
+    size_t size;
+    // Blocks are carved from the top; released blocks below it are kept in a free list.
+    size_t top;
+    arena_block* free_blocks;
+    size_t used;
+    size_t allocation_count;
+    unsigned char huge_pages;
+    // Whether blocks are locked when allocated and whether that succeeded for all of them.
+    unsigned char locking;
+    unsigned char locked;
+} memory_arena;
+
 typedef struct {
     PyObject_HEAD
     jack_client_t* client;
+    // Serializes changes of processors and pool, never taken by the process thread.
+    pthread_mutex_t processors_lock;
+    // State used by the process thread is published with an atomic store,
+    // see client_wait_for_cycle() before freeing what it replaced.
+    processor_list* processors;
+    // NULL without workers
+    worker_pool* pool;
+    // Odd while the process callback is running.
+    unsigned int cycle;
+    // Connections between ports of this client, which force processors to run in attach order.
+    int self_connections;
+    unsigned long worker_fallbacks;
+    memory_arena arena;
     PyObject* port_registered_callback;
     PyObject* port_registered_callback_argument;
     PyObject* port_renamed_callback;
@@ -28,10 +121,34 @@ static PyObject* error;
 static PyObject* failure;
 static PyObject* connection_exists;
 
+static PyTypeObject client_type = {
+    PyObject_HEAD_INIT(NULL)
+    };
+
 static PyTypeObject port_type = {
     PyObject_HEAD_INIT(NULL)
     };
 
+static PyTypeObject bridge_type = {
+    PyObject_HEAD_INIT(NULL)
+    };
+
+static PyTypeObject shared_memory_tap_type = {
+    PyObject_HEAD_INIT(NULL)
+    };
+
+static PyTypeObject spectrum_analyzer_type = {
+    PyObject_HEAD_INIT(NULL)
+    };
+
+static PyTypeObject oscillator_type = {
+    PyObject_HEAD_INIT(NULL)
+    };
+
+static PyTypeObject mixer_type = {
+    PyObject_HEAD_INIT(NULL)
+    };
+
 static PyObject* python_import(const char* name)
 {
     PyObject* python_name = PyString_FromString(name);
@@ -63,10 +180,240 @@ long get_reference_count(PyObject* object)
     return count;
 }
 
+typedef struct {
+    uint64_t timestamp;
+    // Static string
+    const char* name;
+    char phase;
+} trace_event;
+
+// Written by a single thread only.
+typedef struct {
+    trace_event* events;
+    size_t length;
+    pid_t thread_id;
+    unsigned long dropped;
+} trace_buffer;
+
+static int trace_enabled;
+// Threads currently inside trace(), which restarting waits for before resetting the buffers.
+static int trace_writers;
+// Incremented whenever tracing is started, so threads claim a new buffer.
+static unsigned int trace_session;
+// Buffers are kept allocated once tracing was started, as threads may still be writing.
+static trace_buffer* trace_buffers;
+static size_t trace_thread_limit;
+static size_t trace_buffer_count;
+static size_t trace_capacity;
+static __thread trace_buffer* trace_thread_buffer;
+static __thread unsigned int trace_thread_session;
+
+// Kernel thread ID on Linux, as shown by top or perf. Numbered in order of first use elsewhere.
+static pid_t trace_thread_id(void)
+{
+#ifdef __linux__
+    return syscall(SYS_gettid);
+#else
+    static pid_t last_thread_id;
+    static __thread pid_t thread_id;
+    if(!thread_id) {
+        thread_id = __atomic_add_fetch(&last_thread_id, 1, __ATOMIC_RELAXED);
+    }
+    return thread_id;
+#endif
+}
+
+static const char trace_process[] = "process";
+static const char trace_gil_wait[] = "GIL wait";
+static const char trace_python_callback[] = "Python callback";
+
+static void trace_write(const char* name, char phase)
+{
+    unsigned int session = __atomic_load_n(&trace_session, __ATOMIC_ACQUIRE);
+    if(trace_thread_session != session) {
+        size_t buffer_index = __atomic_fetch_add(&trace_buffer_count, 1, __ATOMIC_ACQ_REL);
+        if(buffer_index < trace_thread_limit) {
+            trace_thread_buffer = &trace_buffers[buffer_index];
+            trace_thread_buffer->thread_id = trace_thread_id();
+        } else {
+            trace_thread_buffer = NULL;
+        }
+        trace_thread_session = session;
+    }
+
+    trace_buffer* buffer = trace_thread_buffer;
+    if(!buffer) {
+        return;
+    }
+    if(buffer->length == trace_capacity) {
+        buffer->dropped++;
+        return;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    trace_event* event = &buffer->events[buffer->length];
+    event->timestamp = (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+    event->name = name;
+    event->phase = phase;
+    __atomic_store_n(&buffer->length, buffer->length + 1, __ATOMIC_RELEASE);
+}
+
+// Record the begin ('B') or end ('E') of a span in the calling thread's buffer.
+// Lock-free and allocation-free, so it may be called in the process thread.
+static void trace(const char* name, char phase)
+{
+    if(!__atomic_load_n(&trace_enabled, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    // Announce the write before checking again, so that python_start_tracing()
+    // either sees this thread as a writer or this thread sees tracing disabled.
+    __atomic_add_fetch(&trace_writers, 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&trace_enabled, __ATOMIC_SEQ_CST)) {
+        trace_write(name, phase);
+    }
+    __atomic_sub_fetch(&trace_writers, 1, __ATOMIC_RELEASE);
+}
+
+static PyObject* python_start_tracing(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    unsigned long capacity = 65536;
+    unsigned long thread_limit = 16;
+    static char* kwlist[] = {"events_per_thread", "threads", NULL};
+    if(!PyArg_ParseTupleAndKeywords(args, kwargs, "|kk", kwlist, &capacity, &thread_limit)) {
+        return NULL;
+    }
+    if(!capacity || !thread_limit || capacity > SIZE_MAX / sizeof(trace_event) / thread_limit) {
+        PyErr_SetString(PyExc_ValueError, "Invalid number of events or threads given.");
+        return NULL;
+    }
+
+    if(!trace_buffers) {
+        trace_buffers = (trace_buffer*) calloc(thread_limit, sizeof(trace_buffer));
+        if(!trace_buffers) {
+            return PyErr_NoMemory();
+        }
+        // A single mapping for all events, with its pages faulted in now rather than in the process thread.
+        // malloc() and memset() would not do, as the compiler may merge them into calloc().
+        size_t size = capacity * thread_limit * sizeof(trace_event);
+#ifdef MAP_POPULATE
+        void* events = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+#else
+        void* events = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#endif
+        if(events == MAP_FAILED) {
+            free(trace_buffers);
+            trace_buffers = NULL;
+            return PyErr_SetFromErrno(PyExc_OSError);
+        }
+#ifndef MAP_POPULATE
+        long page_size = sysconf(_SC_PAGESIZE);
+        size_t offset;
+        for(offset = 0; offset < size; offset += page_size) {
+            ((volatile char*)events)[offset] = 0;
+        }
+#endif
+        // Keep them resident if RLIMIT_MEMLOCK permits.
+        mlock(events, size);
+        size_t buffer_index;
+        for(buffer_index = 0; buffer_index < thread_limit; buffer_index++) {
+            trace_buffers[buffer_index].events = (trace_event*)events + buffer_index * capacity;
+        }
+        trace_capacity = capacity;
+        trace_thread_limit = thread_limit;
+    } else if(capacity > trace_capacity || thread_limit > trace_thread_limit) {
+        PyErr_Format(
+            error,
+            "Trace buffers are limited to %lu events per thread and %lu threads.",
+            (unsigned long)trace_capacity, (unsigned long)trace_thread_limit
+            );
+        return NULL;
+    }
+
+    __atomic_store_n(&trace_enabled, 0, __ATOMIC_SEQ_CST);
+    // A thread still writing to the previous session would otherwise
+    // store its length after the reset or claim a buffer of the new session.
+    while(__atomic_load_n(&trace_writers, __ATOMIC_SEQ_CST)) {
+        struct timespec delay = {0, 100000};
+        nanosleep(&delay, NULL);
+    }
+    size_t buffer_index;
+    for(buffer_index = 0; buffer_index < trace_thread_limit; buffer_index++) {
+        trace_buffers[buffer_index].length = 0;
+        trace_buffers[buffer_index].dropped = 0;
+    }
+    __atomic_store_n(&trace_buffer_count, 0, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&trace_session, 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&trace_enabled, 1, __ATOMIC_RELEASE);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* python_stop_tracing(PyObject* self)
+{
+    __atomic_store_n(&trace_enabled, 0, __ATOMIC_RELEASE);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* python_dump_trace(PyObject* self, PyObject* args)
+{
+    const char* path;
+    if(!PyArg_ParseTuple(args, "s", &path)) {
+        return NULL;
+    }
+
+    FILE* file = fopen(path, "w");
+    if(!file) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_IOError, (char*)path);
+    }
+
+    // Chrome trace event format, also understood by Perfetto.
+    fputs("{\"traceEvents\":[", file);
+    unsigned long dropped = 0;
+    unsigned char first = 1;
+    size_t buffer_count = __atomic_load_n(&trace_buffer_count, __ATOMIC_ACQUIRE);
+    if(buffer_count > trace_thread_limit) {
+        buffer_count = trace_thread_limit;
+    }
+    size_t buffer_index;
+    for(buffer_index = 0; buffer_index < buffer_count; buffer_index++) {
+        const trace_buffer* buffer = &trace_buffers[buffer_index];
+        size_t length = __atomic_load_n(&buffer->length, __ATOMIC_ACQUIRE);
+        size_t event_index;
+        for(event_index = 0; event_index < length; event_index++) {
+            const trace_event* event = &buffer->events[event_index];
+            fprintf(
+                file,
+                "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":%d,\"tid\":%d}",
+                first ? "" : ",",
+                event->name,
+                event->phase,
+                (unsigned long long)(event->timestamp / 1000),
+                (unsigned int)(event->timestamp % 1000),
+                (int)getpid(),
+                (int)buffer->thread_id
+                );
+            first = 0;
+        }
+        dropped += buffer->dropped;
+    }
+    fprintf(file, "\n],\"otherData\":{\"dropped\":\"%lu\"}}\n", dropped);
+
+    if(fclose(file)) {
+        return PyErr_SetFromErrnoWithFilename(PyExc_IOError, (char*)path);
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
 static void jack_registration_callback(jack_port_id_t port_id, int registered, void* arg)
 {
     // register: non-zero if the port is being registered, zero if the port is being unregistered
     Client* client = (Client*)arg;
+    trace(__func__, 'B');
 
     PyObject* callback;
     PyObject* callback_argument;
@@ -81,7 +428,9 @@ static void jack_registration_callback(jack_port_id_t port_id, int registered, v
     if(callback) {
         // Ensure that the current thread is ready to call the Python API.
         // No Python API calls are allowed before this call.
+        trace(trace_gil_wait, 'B');
         PyGILState_STATE gil_state = PyGILState_Ensure();
+        trace(trace_gil_wait, 'E');
 
         Port* port = PyObject_New(Port, &port_type);
         port->port = jack_port_by_id(client->client, port_id);
@@ -93,7 +442,9 @@ static void jack_registration_callback(jack_port_id_t port_id, int registered, v
         } else {
             callback_argument_list = Py_BuildValue("(O,O)", (PyObject*)client, (PyObject*)port);
         }
+        trace(trace_python_callback, 'B');
         PyObject* result = PyObject_CallObject(callback, callback_argument_list);
+        trace(trace_python_callback, 'E');
         Py_DECREF(callback_argument_list);
         if(!result) {
             PyErr_PrintEx(0);
@@ -104,6 +455,8 @@ static void jack_registration_callback(jack_port_id_t port_id, int registered, v
         // Release the thread. No Python API calls are allowed beyond this point.
         PyGILState_Release(gil_state);
     }
+
+    trace(__func__, 'E');
 }
 
 // typedef int (*JackPortRenameCallback)(jack_port_id_t port, const char* old_name, const char* new_name, void *arg);
@@ -111,11 +464,14 @@ static int jack_port_renamed_callback(jack_port_id_t port_id, const char* old_na
 {
     int return_code = 0;
     Client* client = (Client*)arg;
+    trace(__func__, 'B');
 
     if(client->port_renamed_callback) {
         // Ensure that the current thread is ready to call the Python API.
         // No Python API calls are allowed before this call.
+        trace(trace_gil_wait, 'B');
         PyGILState_STATE gil_state = PyGILState_Ensure();
+        trace(trace_gil_wait, 'E');
 
         Port* port = PyObject_New(Port, &port_type);
         port->port = jack_port_by_id(client->client, port_id);
@@ -129,7 +485,9 @@ static int jack_port_renamed_callback(jack_port_id_t port_id, const char* old_na
                 new_name,
                 client->port_renamed_callback_argument
                 );
+        trace(trace_python_callback, 'B');
         PyObject* result = PyObject_CallObject(client->port_renamed_callback, callback_argument_list);
+        trace(trace_python_callback, 'E');
         Py_DECREF(callback_argument_list);
         if(!result) {
             PyErr_PrintEx(0);
@@ -143,6 +501,7 @@ static int jack_port_renamed_callback(jack_port_id_t port_id, const char* old_na
         PyGILState_Release(gil_state);
     }
 
+    trace(__func__, 'E');
     return return_code;
 }
 
@@ -150,11 +509,14 @@ static int jack_port_renamed_callback(jack_port_id_t port_id, const char* old_na
 static void jack_shutdown_callback(jack_status_t code, const char* reason, void* arg)
 {
     Client* client = (Client*)arg;
+    trace(__func__, 'B');
 
     if(client->shutdown_callback) {
         // Ensure that the current thread is ready to call the Python API.
         // No Python API calls are allowed before this call.
+        trace(trace_gil_wait, 'B');
         PyGILState_STATE gil_state = PyGILState_Ensure();
+        trace(trace_gil_wait, 'E');
 
         // 'O' increases reference count
         PyObject* callback_argument_list = NULL;
@@ -172,7 +534,9 @@ static void jack_shutdown_callback(jack_status_t code, const char* reason, void*
                 reason
                 );
         }
+        trace(trace_python_callback, 'B');
         PyObject* result = PyObject_CallObject(client->shutdown_callback, callback_argument_list);
+        trace(trace_python_callback, 'E');
         Py_DECREF(callback_argument_list);
         if(!result) {
             PyErr_PrintEx(0);
@@ -183,161 +547,686 @@ static void jack_shutdown_callback(jack_status_t code, const char* reason, void*
         // Release the thread. No Python API calls are allowed beyond this point.
         PyGILState_Release(gil_state);
     }
-}
 
-static PyObject* client___new__(PyTypeObject* type, PyObject* args, PyObject* kwargs)
-{
-    Client* self = (Client*)type->tp_alloc(type, 0);
+    trace(__func__, 'E');
+}
 
-    if(self) {
-        char* client_name;
-        unsigned char use_exact_name = 0;
-        char* server_name = NULL;
-        static char* kwlist[] = {"client_name", "use_exact_name", "server_name", NULL};
-        if(!PyArg_ParseTupleAndKeywords(
-                    args, kwargs, "s|bs", kwlist,
-                    &client_name, &use_exact_name, &server_name
-                    )) {
-            return NULL;
-        }
+// Alignment of arena allocations, one cache line.
+static const size_t arena_alignment = 64;
+static const size_t huge_page_size = 2 * 1024 * 1024;
 
-        jack_options_t open_options = JackNullOption;
-        if(server_name) {
-            open_options |= JackServerName;
-        }
-        if(use_exact_name) {
-            open_options |= JackUseExactName;
-        }
+static int arena_create(memory_arena* a, size_t size, unsigned char huge_pages)
+{
+    memset(a, 0, sizeof(memory_arena));
+    if(!size) {
+        return 0;
+    }
 
-        jack_status_t status;
-        self->client = jack_client_open(client_name, open_options, &status, server_name);
-        if(!self->client) {
-            if(status & JackNameNotUnique) {
-                PyErr_SetString(error, "The desired client name was not unique.");
-            } else if(status & JackServerError) {
-                PyErr_SetString(error, "Communication error with the JACK server.");
-            } else if(status & JackFailure) {
-                PyErr_SetString(failure, "Overall operation failed.");
-            }
-            return NULL;
+    // Pages are faulted in by client_allocate(), not here.
+    void* base = MAP_FAILED;
+    if(huge_pages) {
+        size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+#ifdef MAP_HUGETLB
+        // Without MAP_NORESERVE, this fails right away if not enough huge pages are available.
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(base != MAP_FAILED) {
+            a->huge_pages = 1;
         }
-
-        self->port_registered_callback = NULL;
-        self->port_unregistered_callback = NULL;
-        int error_code = jack_set_port_registration_callback(
-            self->client,
-            jack_registration_callback,
-            (void*)self
-            );
-        if(error_code) {
-            PyErr_SetString(error, "Could not set port registration callback.");
-            return NULL;
+#endif
+    }
+    if(base == MAP_FAILED) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(base == MAP_FAILED) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            return -1;
         }
-
-        self->port_renamed_callback = NULL;
-        self->port_renamed_callback_argument = NULL;
-        error_code = jack_set_port_rename_callback(
-            self->client,
-            jack_port_renamed_callback,
-            (void*)self
-            );
-        if(error_code) {
-            PyErr_SetString(error, "Could not set port rename callback.");
-            return NULL;
+#ifdef MADV_HUGEPAGE
+        // Fall back to transparent huge pages, if available.
+        if(huge_pages) {
+            madvise(base, size, MADV_HUGEPAGE);
         }
-
-        self->shutdown_callback = NULL;
-        self->shutdown_callback_argument = NULL;
-        jack_on_info_shutdown(
-            self->client,
-            jack_shutdown_callback,
-            (void*)self
-            );
+#endif
     }
-
-    return (PyObject*)self;
+    a->base = (char*)base;
+    a->size = size;
+    return 0;
 }
 
-static PyObject* client_activate(Client* self) {
-    int error_code = jack_activate(self->client);
-    if(error_code) {
-        PyErr_SetString(error, "");
-        return NULL;
-    } else {
-        Py_INCREF(Py_None);
-        return Py_None;
+// Lock the pages of the given block, which stay locked until the arena is unmapped.
+static void arena_lock_block(memory_arena* a, char* block, size_t size)
+{
+    size_t page_offset = (uintptr_t)block % sysconf(_SC_PAGESIZE);
+    // mlock() may fail due to RLIMIT_MEMLOCK, but client_allocate() faulted the pages in anyway.
+    if(mlock(block - page_offset, size + page_offset)) {
+        a->locked = 0;
     }
 }
 
-static PyObject* client_deactivate(Client* self) {
-    int error_code = jack_deactivate(self->client);
-    if(error_code) {
-        PyErr_SetString(error, "");
-        return NULL;
-    } else {
-        Py_INCREF(Py_None);
-        return Py_None;
+// Lock the pages of all blocks allocated so far and from now on.
+// The unused part of the arena is left untouched, so it takes no memory.
+static void arena_lock(memory_arena* a)
+{
+    if(!a->base || a->locking) {
+        return;
+    }
+    a->locking = 1;
+    a->locked = 1;
+    if(a->top) {
+        arena_lock_block(a, a->base, a->top);
     }
 }
-#include <stdio.h>
-static PyObject* client_connect(Client* self, PyObject* args)
+
+static void arena_destroy(memory_arena* a)
 {
-    PyObject *source_port_python, *target_port_python;
-    // The object’s reference count is not increased.
-    if(!PyArg_ParseTuple(args, "O!O!", &port_type, &source_port_python, &port_type, &target_port_python)) {
-        return NULL;
+    if(a->base) {
+        munmap(a->base, a->size);
     }
+}
 
-    Port* source_port = (Port*) source_port_python;
-    Port* target_port = (Port*) target_port_python;
-
-    int return_code = jack_connect(
-            self->client,
-            jack_port_name(source_port->port),
-            jack_port_name(target_port->port)
-            );
-
-    if(return_code) {
-        if(return_code == EEXIST) {
-            PyErr_SetString(connection_exists, "The specified ports are already connected.");
+// Return zeroed memory from the client's arena or NULL with a Python exception set.
+// Released blocks are reused first fit, split if large enough.
+static void* client_allocate(Client* client, size_t size)
+{
+    memory_arena* a = &client->arena;
+    arena_block* block = NULL;
+    if(size <= a->size) {
+        size = arena_alignment + (size + arena_alignment - 1) / arena_alignment * arena_alignment;
+        arena_block** link = &a->free_blocks;
+        while(*link && (*link)->size < size) {
+            link = &(*link)->next;
+        }
+        block = *link;
+        if(block) {
+            if(block->size - size >= 2 * arena_alignment) {
+                arena_block* rest = (arena_block*)((char*)block + size);
+                rest->size = block->size - size;
+                rest->next = block->next;
+                *link = rest;
+                block->size = size;
+            } else {
+                *link = block->next;
+            }
+        } else if(size <= a->size - a->top) {
+            block = (arena_block*)(a->base + a->top);
+            block->size = size;
+            a->top += size;
         }
+    }
+    if(!block) {
+        PyErr_Format(
+            error,
+            "Client arena exhausted (%lu of %lu bytes used), increase arena_size.",
+            (unsigned long)a->used, (unsigned long)a->size
+            );
         return NULL;
-    } else {
-        Py_INCREF(Py_None);
-        return Py_None;
     }
+    a->used += block->size;
+    a->allocation_count++;
+    void* memory = (char*)block + arena_alignment;
+    // Fault in the pages here, outside the process thread.
+    memset(memory, 0, block->size - arena_alignment);
+    if(a->locking) {
+        arena_lock_block(a, (char*)block, block->size);
+    }
+    return memory;
 }
 
-static PyObject* client_get_name(Client* self)
+static void client_release(Client* client, void* memory)
 {
-    return (PyObject*)PyString_FromString(jack_get_client_name(self->client));
+    if(!memory) {
+        return;
+    }
+    memory_arena* a = &client->arena;
+    arena_block* block = (arena_block*)((char*)memory - arena_alignment);
+    a->used -= block->size;
+    a->allocation_count--;
+
+    // Insert into the free list by address, merging with adjacent free blocks.
+    arena_block** link = &a->free_blocks;
+    arena_block** previous_link = NULL;
+    while(*link && *link < block) {
+        previous_link = link;
+        link = &(*link)->next;
+    }
+    arena_block* next = *link;
+    if(next && (char*)block + block->size == (char*)next) {
+        block->size += next->size;
+        next = next->next;
+    }
+    block->next = next;
+    *link = block;
+    if(previous_link && (char*)*previous_link + (*previous_link)->size == (char*)block) {
+        (*previous_link)->size += block->size;
+        (*previous_link)->next = next;
+        link = previous_link;
+        block = *link;
+    }
+    // The last free block goes back to the top.
+    if((char*)block + block->size == a->base + a->top) {
+        a->top -= block->size;
+        *link = NULL;
+    }
 }
 
-static PyObject* client_get_ports(Client* self)
+// Equivalent of jack_ringbuffer_create() with the buffer in the client's arena.
+// Release with client_release() instead of jack_ringbuffer_free().
+static jack_ringbuffer_t* client_ringbuffer_create(Client* client, size_t size)
 {
-    PyObject* ports = PyList_New(0);
-    if(!ports) {
-        return NULL;
+    size_t buffer_size = 1;
+    while(buffer_size < size) {
+        buffer_size <<= 1;
+    }
+    jack_ringbuffer_t* ring = (jack_ringbuffer_t*) client_allocate(
+            client, arena_alignment + buffer_size);
+    if(ring) {
+        ring->buf = (char*)ring + arena_alignment;
+        ring->size = buffer_size;
+        ring->size_mask = buffer_size - 1;
+        ring->write_ptr = 0;
+        ring->read_ptr = 0;
+        ring->mlocked = client->arena.locked;
     }
+    return ring;
+}
 
-    const char** port_names = jack_get_ports(self->client, NULL, NULL, 0);
-    int port_index;
-    for(port_index = 0; port_names[port_index] != NULL; port_index++) {
-        Port* port = PyObject_New(Port, &port_type);
-        port->port = jack_port_by_name(self->client, port_names[port_index]);
-        if(PyList_Append(ports, (PyObject*)port)) {
-            return NULL;
-        }
+// Busy waiting iterations before a thread sleeps on a futex.
+static const int worker_spin_count = 2000;
+// Cycles processed without workers after they delayed a cycle by more than a quarter period.
+static const unsigned int worker_fallback_cycles = 256;
+
+#ifdef __linux__
+static void futex_wait(int* address, int value)
+{
+    syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+static void futex_wake(int* address, int count)
+{
+    syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+#else
+// Without futexes, waiting threads poll. Callers check their condition again after waking anyway.
+static void futex_wait(int* address, int value)
+{
+    if(__atomic_load_n(address, __ATOMIC_SEQ_CST) == value) {
+        struct timespec delay = {0, 50000};
+        nanosleep(&delay, NULL);
     }
-    jack_free(port_names);
+}
 
-    return ports;
+static void futex_wake(int* address, int count)
+{
 }
+#endif
 
-static PyObject* client_register_port(Client* self, PyObject* args, PyObject* kwargs)
+static inline void cpu_relax(void)
 {
-    char* name;
-    char* type;
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static void processor_run(processor* p, jack_nframes_t nframes)
+{
+    trace(p->name, 'B');
+    p->process(p, nframes);
+    trace(p->name, 'E');
+}
+
+// Claim and run processors of the given generation until none are left.
+static void worker_pool_run(worker_pool* pool, uint32_t generation)
+{
+    uint64_t claim = __atomic_load_n(&pool->claim, __ATOMIC_ACQUIRE);
+    while((uint32_t)(claim >> 32) == generation && (uint32_t)claim > 0) {
+        if(!__atomic_compare_exchange_n(
+                    &pool->claim, &claim, claim - 1, 1,
+                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
+                    )) {
+            continue;
+        }
+        unsigned int count = pool->count;
+        processor* p = pool->processors[count - (uint32_t)claim];
+        processor_run(p, pool->nframes);
+        if(__atomic_add_fetch(&pool->finished, 1, __ATOMIC_SEQ_CST) == (int)count
+                && __atomic_load_n(&pool->joining, __ATOMIC_SEQ_CST)) {
+            futex_wake(&pool->finished, 1);
+        }
+        claim = __atomic_load_n(&pool->claim, __ATOMIC_ACQUIRE);
+    }
+}
+
+static void* worker_pool_thread(void* arg)
+{
+    worker_pool* pool = (worker_pool*)arg;
+
+    int generation = __atomic_load_n(&pool->generation, __ATOMIC_ACQUIRE);
+    while(1) {
+        int spin;
+        for(spin = 0; spin < worker_spin_count
+                && __atomic_load_n(&pool->generation, __ATOMIC_ACQUIRE) == generation; spin++) {
+            cpu_relax();
+        }
+        // Threads started right before the pool is stopped may have missed the last generation change.
+        while(__atomic_load_n(&pool->generation, __ATOMIC_SEQ_CST) == generation
+                && !__atomic_load_n(&pool->stopping, __ATOMIC_SEQ_CST)) {
+            __atomic_add_fetch(&pool->sleeping, 1, __ATOMIC_SEQ_CST);
+            futex_wait(&pool->generation, generation);
+            __atomic_sub_fetch(&pool->sleeping, 1, __ATOMIC_SEQ_CST);
+        }
+        generation = __atomic_load_n(&pool->generation, __ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&pool->stopping, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        worker_pool_run(pool, generation);
+    }
+
+    return NULL;
+}
+
+static void worker_pool_process(
+        Client* client, worker_pool* pool, processor_list* processors, jack_nframes_t nframes)
+{
+    pool->processors = processors->items;
+    pool->count = processors->count;
+    pool->nframes = nframes;
+    __atomic_store_n(&pool->finished, 0, __ATOMIC_SEQ_CST);
+    uint32_t generation = (uint32_t)pool->generation + 1;
+    __atomic_store_n(&pool->claim, ((uint64_t)generation << 32) | pool->count, __ATOMIC_RELEASE);
+    __atomic_store_n(&pool->generation, generation, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&pool->sleeping, __ATOMIC_SEQ_CST)) {
+        futex_wake(&pool->generation, INT_MAX);
+    }
+
+    worker_pool_run(pool, generation);
+
+    // Wait for processors still running on workers.
+    jack_nframes_t join_start = jack_frames_since_cycle_start(client->client);
+    int spin;
+    for(spin = 0; spin < worker_spin_count
+            && __atomic_load_n(&pool->finished, __ATOMIC_SEQ_CST) != (int)pool->count; spin++) {
+        cpu_relax();
+    }
+    __atomic_store_n(&pool->joining, 1, __ATOMIC_SEQ_CST);
+    int finished;
+    while((finished = __atomic_load_n(&pool->finished, __ATOMIC_SEQ_CST)) != (int)pool->count) {
+        futex_wait(&pool->finished, finished);
+    }
+    __atomic_store_n(&pool->joining, 0, __ATOMIC_SEQ_CST);
+
+    if(jack_frames_since_cycle_start(client->client) - join_start > nframes / 4) {
+        pool->serial_cycles = worker_fallback_cycles;
+        client->worker_fallbacks++;
+    }
+}
+
+// Join all threads and release the pool, which must no longer be used by the process thread.
+static void worker_pool_stop(Client* client, worker_pool* pool)
+{
+    __atomic_store_n(&pool->stopping, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&pool->generation, 1, __ATOMIC_SEQ_CST);
+    futex_wake(&pool->generation, INT_MAX);
+    size_t thread_index;
+    for(thread_index = 0; thread_index < pool->thread_count; thread_index++) {
+        jack_client_stop_thread(pool->client, pool->threads[thread_index]);
+    }
+    client_release(client, pool->threads);
+    client_release(client, pool);
+}
+
+// Return a new pool with running threads or NULL with a Python exception set.
+static worker_pool* worker_pool_start(Client* client, unsigned int count)
+{
+    worker_pool* pool = (worker_pool*) client_allocate(client, sizeof(worker_pool));
+    if(!pool) {
+        return NULL;
+    }
+    pool->client = client->client;
+    pool->threads = (jack_native_thread_t*) client_allocate(client, count * sizeof(jack_native_thread_t));
+    if(!pool->threads) {
+        client_release(client, pool);
+        return NULL;
+    }
+    while(pool->thread_count < count) {
+        if(jack_client_create_thread(
+                    client->client,
+                    &pool->threads[pool->thread_count],
+                    jack_client_real_time_priority(client->client),
+                    jack_is_realtime(client->client),
+                    worker_pool_thread,
+                    pool
+                    )) {
+            worker_pool_stop(client, pool);
+            PyErr_SetString(error, "Could not create worker thread.");
+            return NULL;
+        }
+        pool->thread_count++;
+    }
+    return pool;
+}
+
+// typedef int (*JackProcessCallback)(jack_nframes_t nframes, void *arg);
+static int jack_process_callback(jack_nframes_t nframes, void* arg)
+{
+    Client* client = (Client*)arg;
+    trace(trace_process, 'B');
+
+    // Announce the cycle before loading the state it works on, see client_wait_for_cycle().
+    // The process thread therefore never waits for other threads changing that state.
+    __atomic_add_fetch(&client->cycle, 1, __ATOMIC_SEQ_CST);
+    processor_list* processors = __atomic_load_n(&client->processors, __ATOMIC_SEQ_CST);
+    worker_pool* pool = __atomic_load_n(&client->pool, __ATOMIC_SEQ_CST);
+    if(processors) {
+        // An input connected to an output of this client is read when its processor gets the buffer,
+        // so it must not run concurrently with the processor writing the output.
+        if(pool && processors->count > 1 && !pool->serial_cycles
+                && !__atomic_load_n(&client->self_connections, __ATOMIC_ACQUIRE)) {
+            worker_pool_process(client, pool, processors, nframes);
+        } else {
+            if(pool && pool->serial_cycles) {
+                pool->serial_cycles--;
+            }
+            size_t processor_index;
+            for(processor_index = 0; processor_index < processors->count; processor_index++) {
+                processor_run(processors->items[processor_index], nframes);
+            }
+        }
+    }
+    __atomic_add_fetch(&client->cycle, 1, __ATOMIC_RELEASE);
+
+    trace(trace_process, 'E');
+    return 0;
+}
+
+// Wait until the process thread no longer uses state replaced before this call.
+// A cycle starting after the replacement already loads the new state,
+// so at most the cycle currently running has to finish.
+static void client_wait_for_cycle(Client* client)
+{
+    unsigned int cycle = __atomic_load_n(&client->cycle, __ATOMIC_SEQ_CST);
+    if(cycle & 1) {
+        while(__atomic_load_n(&client->cycle, __ATOMIC_ACQUIRE) == cycle) {
+            struct timespec delay = {0, 100000};
+            nanosleep(&delay, NULL);
+        }
+    }
+}
+
+// Publish processors and wait until the process thread no longer uses the previous list.
+static void client_replace_processors(Client* client, processor_list* processors)
+{
+    processor_list* previous_processors = client->processors;
+    __atomic_store_n(&client->processors, processors, __ATOMIC_SEQ_CST);
+    client_wait_for_cycle(client);
+    client_release(client, previous_processors);
+}
+
+static int client_attach_processor(Client* client, processor* p)
+{
+    pthread_mutex_lock(&client->processors_lock);
+    size_t count = client->processors ? client->processors->count : 0;
+    processor_list* processors = (processor_list*) client_allocate(
+            client, sizeof(processor_list) + (count + 1) * sizeof(processor*));
+    if(!processors) {
+        pthread_mutex_unlock(&client->processors_lock);
+        return -1;
+    }
+    if(count) {
+        memcpy(processors->items, client->processors->items, count * sizeof(processor*));
+    }
+    processors->items[count] = p;
+    processors->count = count + 1;
+    client_replace_processors(client, processors);
+    pthread_mutex_unlock(&client->processors_lock);
+    return 0;
+}
+
+// Once this returns, the process thread no longer runs the processor.
+static void client_detach_processor(Client* client, processor* p)
+{
+    pthread_mutex_lock(&client->processors_lock);
+    processor_list* previous_processors = client->processors;
+    size_t count = previous_processors ? previous_processors->count : 0;
+    size_t processor_index;
+    for(processor_index = 0; processor_index < count; processor_index++) {
+        if(previous_processors->items[processor_index] == p) {
+            break;
+        }
+    }
+    if(processor_index < count) {
+        // Shrinking never needs more memory, so reuse the list if allocation fails
+        // after taking it out of the process thread's reach.
+        processor_list* processors = NULL;
+        if(count > 1) {
+            // Detaching is part of deallocation, so keep any exception already set instead.
+            PyObject *type, *value, *traceback;
+            PyErr_Fetch(&type, &value, &traceback);
+            processors = (processor_list*) client_allocate(
+                    client, sizeof(processor_list) + (count - 1) * sizeof(processor*));
+            PyErr_Restore(type, value, traceback);
+        }
+        if(count > 1 && !processors) {
+            __atomic_store_n(&client->processors, NULL, __ATOMIC_SEQ_CST);
+            client_wait_for_cycle(client);
+            processors = previous_processors;
+            memmove(
+                &processors->items[processor_index],
+                &processors->items[processor_index + 1],
+                (count - processor_index - 1) * sizeof(processor*)
+                );
+            processors->count--;
+            __atomic_store_n(&client->processors, processors, __ATOMIC_SEQ_CST);
+        } else {
+            if(processors) {
+                memcpy(processors->items, previous_processors->items, processor_index * sizeof(processor*));
+                memcpy(
+                    &processors->items[processor_index],
+                    &previous_processors->items[processor_index + 1],
+                    (count - processor_index - 1) * sizeof(processor*)
+                    );
+                processors->count = count - 1;
+            }
+            client_replace_processors(client, processors);
+        }
+    }
+    pthread_mutex_unlock(&client->processors_lock);
+}
+
+// typedef void (*JackPortConnectCallback)(jack_port_id_t a, jack_port_id_t b, int connect, void* arg);
+static void jack_port_connected_callback(jack_port_id_t a, jack_port_id_t b, int connect, void* arg)
+{
+    Client* client = (Client*)arg;
+    if(jack_port_is_mine(client->client, jack_port_by_id(client->client, a))
+            && jack_port_is_mine(client->client, jack_port_by_id(client->client, b))) {
+        __atomic_add_fetch(&client->self_connections, connect ? 1 : -1, __ATOMIC_RELEASE);
+    }
+}
+
+static PyObject* client___new__(PyTypeObject* type, PyObject* args, PyObject* kwargs)
+{
+    Client* self = (Client*)type->tp_alloc(type, 0);
+
+    if(self) {
+        char* client_name;
+        unsigned char use_exact_name = 0;
+        char* server_name = NULL;
+        unsigned long arena_size = 4 * 1024 * 1024;
+        unsigned char huge_pages = 0;
+        static char* kwlist[] = {"client_name", "use_exact_name", "server_name", "arena_size", "huge_pages", NULL};
+        if(!PyArg_ParseTupleAndKeywords(
+                    args, kwargs, "s|bskb", kwlist,
+                    &client_name, &use_exact_name, &server_name, &arena_size, &huge_pages
+                    )) {
+            return NULL;
+        }
+
+        jack_options_t open_options = JackNullOption;
+        if(server_name) {
+            open_options |= JackServerName;
+        }
+        if(use_exact_name) {
+            open_options |= JackUseExactName;
+        }
+
+        jack_status_t status;
+        self->client = jack_client_open(client_name, open_options, &status, server_name);
+        if(!self->client) {
+            if(status & JackNameNotUnique) {
+                PyErr_SetString(error, "The desired client name was not unique.");
+            } else if(status & JackServerError) {
+                PyErr_SetString(error, "Communication error with the JACK server.");
+            } else if(status & JackFailure) {
+                PyErr_SetString(failure, "Overall operation failed.");
+            }
+            return NULL;
+        }
+
+        pthread_mutex_init(&self->processors_lock, NULL);
+        self->processors = NULL;
+        self->pool = NULL;
+        self->cycle = 0;
+        self->self_connections = 0;
+        self->worker_fallbacks = 0;
+        if(arena_create(&self->arena, arena_size, huge_pages)) {
+            return NULL;
+        }
+        if(jack_set_process_callback(self->client, jack_process_callback, (void*)self)) {
+            PyErr_SetString(error, "Could not set process callback.");
+            return NULL;
+        }
+        if(jack_set_port_connect_callback(self->client, jack_port_connected_callback, (void*)self)) {
+            PyErr_SetString(error, "Could not set port connect callback.");
+            return NULL;
+        }
+
+        self->port_registered_callback = NULL;
+        self->port_unregistered_callback = NULL;
+        int error_code = jack_set_port_registration_callback(
+            self->client,
+            jack_registration_callback,
+            (void*)self
+            );
+        if(error_code) {
+            PyErr_SetString(error, "Could not set port registration callback.");
+            return NULL;
+        }
+
+        self->port_renamed_callback = NULL;
+        self->port_renamed_callback_argument = NULL;
+        error_code = jack_set_port_rename_callback(
+            self->client,
+            jack_port_renamed_callback,
+            (void*)self
+            );
+        if(error_code) {
+            PyErr_SetString(error, "Could not set port rename callback.");
+            return NULL;
+        }
+
+        self->shutdown_callback = NULL;
+        self->shutdown_callback_argument = NULL;
+        jack_on_info_shutdown(
+            self->client,
+            jack_shutdown_callback,
+            (void*)self
+            );
+    }
+
+    return (PyObject*)self;
+}
+
+static PyObject* client_activate(Client* self) {
+    arena_lock(&self->arena);
+    int error_code = jack_activate(self->client);
+    if(error_code) {
+        PyErr_SetString(error, "");
+        return NULL;
+    } else {
+        Py_INCREF(Py_None);
+        return Py_None;
+    }
+}
+
+static PyObject* client_deactivate(Client* self) {
+    int error_code = jack_deactivate(self->client);
+    if(error_code) {
+        PyErr_SetString(error, "");
+        return NULL;
+    } else {
+        // Deactivating disconnects all ports.
+        __atomic_store_n(&self->self_connections, 0, __ATOMIC_RELEASE);
+        Py_INCREF(Py_None);
+        return Py_None;
+    }
+}
+#include <stdio.h>
+static PyObject* client_connect(Client* self, PyObject* args)
+{
+    PyObject *source_port_python, *target_port_python;
+    // The object’s reference count is not increased.
+    if(!PyArg_ParseTuple(args, "O!O!", &port_type, &source_port_python, &port_type, &target_port_python)) {
+        return NULL;
+    }
+
+    Port* source_port = (Port*) source_port_python;
+    Port* target_port = (Port*) target_port_python;
+
+    int return_code = jack_connect(
+            self->client,
+            jack_port_name(source_port->port),
+            jack_port_name(target_port->port)
+            );
+
+    if(return_code) {
+        if(return_code == EEXIST) {
+            PyErr_SetString(connection_exists, "The specified ports are already connected.");
+        }
+        return NULL;
+    } else {
+        Py_INCREF(Py_None);
+        return Py_None;
+    }
+}
+
+static PyObject* client_get_name(Client* self)
+{
+    return (PyObject*)PyString_FromString(jack_get_client_name(self->client));
+}
+
+static PyObject* client_get_frame_time(Client* self)
+{
+    return PyLong_FromUnsignedLong(jack_frame_time(self->client));
+}
+
+static PyObject* client_get_sample_rate(Client* self)
+{
+    return PyLong_FromUnsignedLong(jack_get_sample_rate(self->client));
+}
+
+static PyObject* client_get_ports(Client* self)
+{
+    PyObject* ports = PyList_New(0);
+    if(!ports) {
+        return NULL;
+    }
+
+    const char** port_names = jack_get_ports(self->client, NULL, NULL, 0);
+    int port_index;
+    for(port_index = 0; port_names[port_index] != NULL; port_index++) {
+        Port* port = PyObject_New(Port, &port_type);
+        port->port = jack_port_by_name(self->client, port_names[port_index]);
+        if(PyList_Append(ports, (PyObject*)port)) {
+            return NULL;
+        }
+    }
+    jack_free(port_names);
+
+    return ports;
+}
+
+static PyObject* client_register_port(Client* self, PyObject* args, PyObject* kwargs)
+{
+    char* name;
+    char* type;
     int direction;
     unsigned char physical = 0;
     unsigned char terminal = 0;
@@ -360,408 +1249,2247 @@ static PyObject* client_register_port(Client* self, PyObject* args, PyObject* kw
     } else if(direction == port_output) {
         flags |= JackPortIsOutput;
     } else {
-        PyErr_SetString(PyExc_ValueError, "Invalid port direction given.");
-        return NULL;
-    }
-    if(physical) {
-        flags |= JackPortIsPhysical;
+        PyErr_SetString(PyExc_ValueError, "Invalid port direction given.");
+        return NULL;
+    }
+    if(physical) {
+        flags |= JackPortIsPhysical;
+    }
+    if(terminal) {
+        flags |= JackPortIsTerminal;
+    }
+
+    Port* port = PyObject_New(Port, &port_type);
+    port->port = jack_port_register(
+            self->client,
+            name,
+            type,
+            flags,
+            buffer_size
+            );
+    if(!port->port) {
+        PyErr_SetString(error, "Could not register port.");
+        return NULL;
+    }
+    return (PyObject*)port;
+}
+
+static PyObject* client_get_port_type_buffer_size(Client* self, PyObject* args)
+{
+    const char* type;
+    if(!PyArg_ParseTuple(args, "s", &type)) {
+        return NULL;
+    }
+
+    return PyInt_FromSize_t(jack_port_type_get_buffer_size(self->client, type));
+}
+
+static PyObject* client_set_worker_count(Client* self, PyObject* args)
+{
+    unsigned int count;
+    if(!PyArg_ParseTuple(args, "I", &count)) {
+        return NULL;
+    }
+
+    // The process thread keeps using the previous pool until it has picked up the new one.
+    worker_pool* pool = NULL;
+    if(count) {
+        pool = worker_pool_start(self, count);
+        if(!pool) {
+            return NULL;
+        }
+    }
+
+    pthread_mutex_lock(&self->processors_lock);
+    worker_pool* previous_pool = self->pool;
+    __atomic_store_n(&self->pool, pool, __ATOMIC_SEQ_CST);
+    client_wait_for_cycle(self);
+    pthread_mutex_unlock(&self->processors_lock);
+
+    if(previous_pool) {
+        worker_pool_stop(self, previous_pool);
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* client_get_worker_count(Client* self)
+{
+    return PyInt_FromSize_t(self->pool ? self->pool->thread_count : 0);
+}
+
+static PyObject* client_get_arena_usage(Client* self)
+{
+    return Py_BuildValue(
+        "{s:k,s:k,s:k,s:O,s:O}",
+        "size", (unsigned long)self->arena.size,
+        "used", (unsigned long)self->arena.used,
+        "allocations", (unsigned long)self->arena.allocation_count,
+        "locked", self->arena.locked ? Py_True : Py_False,
+        "huge_pages", self->arena.huge_pages ? Py_True : Py_False
+        );
+}
+
+static PyObject* client_get_worker_fallbacks(Client* self)
+{
+    return PyLong_FromUnsignedLong(self->worker_fallbacks);
+}
+
+static PyObject* client_set_port_registered_callback(Client* self, PyObject* args)
+{
+    PyObject* callback = 0;
+    PyObject* callback_argument = 0;
+    if(!PyArg_ParseTuple(args, "O|O", &callback, &callback_argument)) {
+        return NULL;
+    }
+    if(!PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "Parameter must be callable.");
+        return NULL;
+    }
+
+    Py_XINCREF(callback);
+    Py_XDECREF(self->port_registered_callback);
+    self->port_registered_callback = callback;
+
+    Py_XINCREF(callback_argument);
+    Py_XDECREF(self->port_registered_callback_argument);
+    self->port_registered_callback_argument = callback_argument;
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* client_set_port_unregistered_callback(Client* self, PyObject* args)
+{
+    PyObject* callback = 0;
+    PyObject* callback_argument = 0;
+    if(!PyArg_ParseTuple(args, "O|O", &callback, &callback_argument)) {
+        return NULL;
+    }
+    if(!PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "Parameter must be callable.");
+        return NULL;
+    }
+
+    Py_XINCREF(callback);
+    Py_XDECREF(self->port_unregistered_callback);
+    self->port_unregistered_callback = callback;
+
+    Py_XINCREF(callback_argument);
+    Py_XDECREF(self->port_unregistered_callback_argument);
+    self->port_unregistered_callback_argument = callback_argument;
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* client_set_port_renamed_callback(Client* self, PyObject* args)
+{
+    PyObject* callback = 0;
+    PyObject* callback_argument = 0;
+    if(!PyArg_ParseTuple(args, "O|O", &callback, &callback_argument)) {
+        return NULL;
+    }
+    if(!PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "Parameter must be callable.");
+        return NULL;
+    }
+
+    Py_XINCREF(callback);
+    Py_XDECREF(self->port_renamed_callback);
+    self->port_renamed_callback = callback;
+
+    Py_XINCREF(callback_argument);
+    Py_XDECREF(self->port_renamed_callback_argument);
+    self->port_renamed_callback_argument = callback_argument;
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* client_set_shutdown_callback(Client* self, PyObject* args)
+{
+    PyObject* callback = 0;
+    PyObject* callback_argument = 0;
+    if(!PyArg_ParseTuple(args, "O|O", &callback, &callback_argument)) {
+        return NULL;
+    }
+    if(!PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "Parameter must be callable.");
+        return NULL;
+    }
+
+    Py_XINCREF(callback);
+    Py_XDECREF(self->shutdown_callback);
+    self->shutdown_callback = callback;
+
+    Py_XINCREF(callback_argument);
+    Py_XDECREF(self->shutdown_callback_argument);
+    self->shutdown_callback_argument = callback_argument;
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static void client_dealloc(Client* self)
+{
+    pthread_mutex_lock(&self->processors_lock);
+    worker_pool* pool = self->pool;
+    __atomic_store_n(&self->pool, NULL, __ATOMIC_SEQ_CST);
+    client_wait_for_cycle(self);
+    pthread_mutex_unlock(&self->processors_lock);
+    if(pool) {
+        worker_pool_stop(self, pool);
+    }
+
+    jack_client_close(self->client);
+
+    pthread_mutex_destroy(&self->processors_lock);
+    // The processor list, if any, is part of the arena.
+    arena_destroy(&self->arena);
+
+    Py_XDECREF(self->port_registered_callback);
+    Py_XDECREF(self->port_registered_callback_argument);
+    Py_XDECREF(self->port_renamed_callback);
+    Py_XDECREF(self->port_renamed_callback_argument);
+    Py_XDECREF(self->port_unregistered_callback);
+    Py_XDECREF(self->port_unregistered_callback_argument);
+    Py_XDECREF(self->shutdown_callback);
+    Py_XDECREF(self->shutdown_callback_argument);
+
+    self->ob_type->tp_free((PyObject*)self);
+}
+
+static PyMethodDef client_methods[] = {
+    {
+        "activate",
+        (PyCFunction)client_activate,
+        METH_NOARGS,
+        "Tell the Jack server that the program is ready to start processing audio.",
+        },
+    {
+        "get_arena_usage",
+        (PyCFunction)client_get_arena_usage,
+        METH_NOARGS,
+        "Return size and usage of the memory arena holding the buffers of the process thread.",
+        },
+    {
+        "connect",
+        (PyCFunction)client_connect,
+        METH_VARARGS,
+        "Establish a connection between two ports.",
+        },
+    {
+        "deactivate",
+        (PyCFunction)client_deactivate,
+        METH_NOARGS,
+        "Tell the Jack server that the program is ready to start processing audio.",
+        },
+    {
+        "get_name",
+        (PyCFunction)client_get_name,
+        METH_NOARGS,
+        "Return client's actual name.",
+        },
+    {
+        "get_frame_time",
+        (PyCFunction)client_get_frame_time,
+        METH_NOARGS,
+        "Return estimated current time in frames, e.g. to schedule mixer parameter changes.",
+        },
+    {
+        "get_sample_rate",
+        (PyCFunction)client_get_sample_rate,
+        METH_NOARGS,
+        "Return the sample rate of the JACK server.",
+        },
+    {
+        "get_worker_count",
+        (PyCFunction)client_get_worker_count,
+        METH_NOARGS,
+        "Return number of threads helping the process thread.",
+        },
+    {
+        "get_worker_fallbacks",
+        (PyCFunction)client_get_worker_fallbacks,
+        METH_NOARGS,
+        "Return how often workers were late and the process thread continued on its own for a while.",
+        },
+    {
+        "get_ports",
+        (PyCFunction)client_get_ports,
+        METH_NOARGS,
+        "Return list of ports.",
+        },
+    {
+        "get_port_type_buffer_size",
+        (PyCFunction)client_get_port_type_buffer_size,
+        METH_VARARGS,
+        "Return size of a port buffer of the given type in bytes.",
+        },
+    {
+        "register_port",
+        (PyCFunction)client_register_port,
+        METH_VARARGS | METH_KEYWORDS,
+        "Register a new port for the client.",
+        },
+    {
+        "set_worker_count",
+        (PyCFunction)client_set_worker_count,
+        METH_VARARGS,
+        "Start the given number of real-time threads sharing the in-process work of each cycle. "
+        "While ports of the client are connected to each other, its processing stays on the process thread.",
+        },
+    {
+        "set_port_registered_callback",
+        (PyCFunction)client_set_port_registered_callback,
+        METH_VARARGS,
+        "Tell the JACK server to call a function whenever a port is registered.",
+        },
+    {
+        "set_port_unregistered_callback",
+        (PyCFunction)client_set_port_unregistered_callback,
+        METH_VARARGS,
+        "Tell the JACK server to call a function whenever a port is unregistered.",
+        },
+    {
+        "set_port_renamed_callback",
+        (PyCFunction)client_set_port_renamed_callback,
+        METH_VARARGS,
+        "Tell the JACK server to call a function whenever a port is renamed.",
+        },
+    {
+        "set_shutdown_callback",
+        (PyCFunction)client_set_shutdown_callback,
+        METH_VARARGS,
+        "Tell the JACK server to call a function when the server shuts down the client.",
+        },
+    {NULL},
+    };
+
+unsigned char port_is_input(const Port* port)
+{
+    return jack_port_flags(port->port) & JackPortIsInput;
+}
+
+static PyObject* python_port_is_input(Port* self)
+{
+    // The flags "JackPortIsInput" and "JackPortIsOutput" are mutually exclusive.
+    return (PyObject*)PyBool_FromLong(port_is_input(self));
+}
+
+unsigned char port_is_output(const Port* port)
+{
+    return jack_port_flags(port->port) & JackPortIsOutput;
+}
+
+static PyObject* python_port_is_output(Port* self)
+{
+    // The flags "JackPortIsInput" and "JackPortIsOutput" are mutually exclusive.
+    return (PyObject*)PyBool_FromLong(port_is_output(self));
+}
+
+static PyObject* port_get_name(Port* self)
+{
+    return (PyObject*)PyString_FromString(jack_port_name(self->port));
+}
+
+static PyObject* port_get_short_name(Port* self)
+{
+    return (PyObject*)PyString_FromString(jack_port_short_name(self->port));
+}
+
+static PyObject* port_get_type(Port* self)
+{
+    return (PyObject*)PyString_FromString(jack_port_type(self->port));
+}
+
+static PyObject* port_set_short_name(Port* self, PyObject* args)
+{
+    const char* name;
+    if(!PyArg_ParseTuple(args, "s", &name)) {
+        return NULL;
+    }
+
+    // 0 on success, otherwise a non-zero error code.
+    if(jack_port_set_name(self->port, name)) {
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* port_get_client_name(Port* self)
+{
+    // e.g. "PulseAudio JACK Sink:front-left"
+    const char* port_name = jack_port_name(self->port);
+
+    int client_name_length = strlen(port_name) - strlen(jack_port_short_name(self->port)) - 1;
+
+    // e.g. "PulseAudio JACK Sink"
+    char* client_name = (char*) malloc(jack_port_name_size());
+    strncpy(client_name, port_name, client_name_length);
+    client_name[client_name_length] = '\0';
+    PyObject* client_name_python = PyString_FromString(client_name);
+    free(client_name);
+
+    return client_name_python;
+}
+
+static PyObject* port_get_aliases(Port* self)
+{
+    PyObject* aliases_list = PyList_New(0);
+    if(!aliases_list) {
+        return NULL;
+    }
+
+    char* aliases[2];
+    aliases[0] = (char*) malloc(jack_port_name_size());
+    aliases[1] = (char*) malloc(jack_port_name_size());
+    int alias_count = jack_port_get_aliases(self->port, aliases);
+    int alias_index;
+    for(alias_index = 0; alias_index < alias_count; alias_index++) {
+        PyList_Append(aliases_list, PyString_FromString(aliases[alias_index]));
+    }
+    free(aliases[0]);
+    free(aliases[1]);
+
+    return aliases_list;
+}
+
+unsigned char port_is_physical(const Port* port)
+{
+    return jack_port_flags(port->port) & JackPortIsPhysical;
+}
+
+unsigned char port_is_terminal(const Port* port)
+{
+    return jack_port_flags(port->port) & JackPortIsTerminal;
+}
+
+static PyObject* port___repr__(Port* self)
+{
+    static PyObject* format;
+    if(!format) {
+        format = PyString_FromString(
+                "jack.Port(name = '%s', type = '%s', direction = %s, physical = %s, terminal = %s)"
+                );
+    }
+    PyObject* args = Py_BuildValue(
+            "(s,s,s,s,s)",
+            jack_port_name(self->port),
+            jack_port_type(self->port),
+            port_is_input(self) ? "jack.Input" : (port_is_output(self) ? "jack.Output" : "?"),
+            port_is_physical(self) ? "True" : "False",
+            port_is_terminal(self) ? "True" : "False"
+            );
+    PyObject* repr = PyString_Format(format, args);
+    Py_DECREF(args);
+    return repr;
+}
+
+static unsigned char port_equal(const Port* port_a, const Port* port_b) 
+{
+    // return jack_port_uuid(port_a->port) == jack_port_uuid(port_b->port);
+    return strcmp(jack_port_name(port_a->port), jack_port_name(port_b->port)) == 0;
+}
+
+static PyObject* port_richcompare(Port* port_a, Port* port_b, int operation)
+{
+    PyObject* result; 
+
+    switch(operation) {
+        case Py_EQ:
+            result = port_equal(port_a, port_b) ? Py_True : Py_False;
+            break;
+        case Py_NE:
+            result = !port_equal(port_a, port_b) ? Py_True : Py_False;
+            break;
+        default:
+            PyErr_SetString(PyExc_ValueError, "This operation is not available for jack ports.");
+            return NULL;
+    }
+
+    Py_INCREF(result);
+    return result;
+}
+
+static void port_dealloc(Port* self)
+{
+    self->ob_type->tp_free((PyObject*)self);
+}
+
+static PyMethodDef port_methods[] = {
+    {
+        "is_input",
+        (PyCFunction)python_port_is_input,
+        METH_NOARGS,
+        "Return true if the port can receive data.",
+        },
+    {
+        "is_output",
+        (PyCFunction)python_port_is_output,
+        METH_NOARGS,
+        "Return true if data can be read from the port.",
+        },
+    {
+        "get_name",
+        (PyCFunction)port_get_name,
+        METH_NOARGS,
+        "Return port's name.",
+        },
+    {
+        "get_short_name",
+        (PyCFunction)port_get_short_name,
+        METH_NOARGS,
+        "Return port's name without the preceding name of the associated client.",
+        },
+    {
+        "get_type",
+        (PyCFunction)port_get_type,
+        METH_NOARGS,
+        "Return port's type.",
+        },
+    {
+        "get_client_name",
+        (PyCFunction)port_get_client_name,
+        METH_NOARGS,
+        "Return the name of the associated client.",
+        },
+    {
+        "set_short_name",
+        (PyCFunction)port_set_short_name,
+        METH_VARARGS,
+        "Modify a port's short name. May be called at any time.",
+        },
+    {
+        "get_aliases",
+        (PyCFunction)port_get_aliases,
+        METH_NOARGS,
+        "Return list of assigned aliases.",
+        },
+    {NULL},
+    };
+
+typedef struct {
+    PyObject_HEAD
+    Client* source_client;
+    Port* source_port;
+    Client* target_client;
+    Port* target_port;
+    processor source_processor;
+    processor target_processor;
+    // Single producer (source process thread), single consumer (target process thread).
+    jack_ringbuffer_t* ring;
+    // Average number of buffered samples the resampler tries to keep in the ring.
+    size_t latency;
+    jack_nframes_t source_buffer_size;
+    jack_nframes_t source_sample_rate;
+    // Seqlock protecting source_time against the ring's write pointer, odd while the source is writing.
+    unsigned int source_sequence;
+    // CLOCK_MONOTONIC in nanoseconds at the last write of the source.
+    uint64_t source_time;
+    // Input samples consumed per output sample without drift.
+    double nominal_ratio;
+    double ratio;
+    // Source samples consumed per target cycle without drift.
+    double samples_per_cycle;
+    // Target cycles the fill level takes to settle after a disturbance.
+    double settling_cycles;
+    double filtered_fill;
+    double drift;
+    // Position between previous_sample and current_sample.
+    double phase;
+    float previous_sample;
+    float current_sample;
+    // Written by the target, read by the source.
+    unsigned char primed;
+    unsigned long underruns;
+    unsigned long overruns;
+} Bridge;
+
+// Maximum relative deviation of the resampling ratio from the nominal one.
+static const double bridge_correction_limit = 5e-3;
+
+static size_t bridge_get_fill(const Bridge* bridge)
+{
+    return jack_ringbuffer_read_space(bridge->ring) / sizeof(float);
+}
+
+static uint64_t monotonic_time(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void bridge_process_source(processor* p, jack_nframes_t nframes)
+{
+    Bridge* bridge = container_of(p, Bridge, source_processor);
+
+    unsigned int sequence = bridge->source_sequence;
+    __atomic_store_n(&bridge->source_sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    const float* samples = (const float*) jack_port_get_buffer(bridge->source_port->port, nframes);
+    // Only write whole samples.
+    size_t space = jack_ringbuffer_write_space(bridge->ring) / sizeof(float);
+    size_t count = nframes;
+    if(count > space) {
+        count = space;
+        // The ring fills up while the target is not running yet, which is no loss.
+        if(__atomic_load_n(&bridge->primed, __ATOMIC_ACQUIRE)) {
+            bridge->overruns++;
+        }
+    }
+    jack_ringbuffer_write(bridge->ring, (const char*)samples, count * sizeof(float));
+    bridge->source_time = monotonic_time();
+
+    __atomic_store_n(&bridge->source_sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+// Samples arrive in blocks of a source period, so the fill level seen by the target jumps
+// depending on the phase between both servers. Adding the samples the source has received
+// since its last cycle yields a level that only changes with the actual drift.
+static double bridge_estimate_fill(Bridge* bridge)
+{
+    size_t fill;
+    uint64_t source_time;
+    int attempt = 0;
+    while(1) {
+        unsigned int sequence = __atomic_load_n(&bridge->source_sequence, __ATOMIC_ACQUIRE);
+        fill = bridge_get_fill(bridge);
+        source_time = bridge->source_time;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(!(sequence & 1) && sequence == __atomic_load_n(&bridge->source_sequence, __ATOMIC_RELAXED)) {
+            break;
+        }
+        // The source only copies one period while holding the sequence odd.
+        if(++attempt == 1000) {
+            return fill + bridge->source_buffer_size / 2.0;
+        }
+        cpu_relax();
+    }
+
+    double received = (double)(monotonic_time() - source_time) * 1e-9 * bridge->source_sample_rate;
+    if(received > bridge->source_buffer_size) {
+        received = bridge->source_buffer_size;
+    }
+    return fill + received;
+}
+
+// Estimate at which the fill level averages to the latency over time:
+// the source adds a period at once and the target removes one at once.
+static double bridge_get_target_fill(const Bridge* bridge)
+{
+    return bridge->latency + (bridge->source_buffer_size + bridge->samples_per_cycle) / 2;
+}
+
+static void bridge_update_ratio(Bridge* bridge, double fill)
+{
+    // Smooth scheduling jitter well within the settling time of the loop.
+    bridge->filtered_fill += 8 / bridge->settling_cycles * (fill - bridge->filtered_fill);
+    double error = bridge->filtered_fill - bridge_get_target_fill(bridge);
+
+    // Critically damped PI controller on the fill level. The fill level integrates the ratio,
+    // so the integral term converges to the actual clock drift between both servers.
+    double gain = 1 / (bridge->samples_per_cycle * bridge->settling_cycles);
+    double correction = 2 * gain * error + bridge->drift;
+    if(correction > -bridge_correction_limit && correction < bridge_correction_limit) {
+        // Stop integrating while the correction is limited, so the drift does not wind up.
+        bridge->drift += gain * error / bridge->settling_cycles;
+    }
+    if(correction > bridge_correction_limit) {
+        correction = bridge_correction_limit;
+    } else if(correction < -bridge_correction_limit) {
+        correction = -bridge_correction_limit;
+    }
+
+    bridge->ratio = bridge->nominal_ratio * (1.0 + correction);
+}
+
+static void bridge_process_target(processor* p, jack_nframes_t nframes)
+{
+    Bridge* bridge = container_of(p, Bridge, target_processor);
+
+    float* samples = (float*) jack_port_get_buffer(bridge->target_port->port, nframes);
+
+    double fill = bridge_estimate_fill(bridge);
+    if(!bridge->primed) {
+        // A full ring holds samples from before the target started, drop them.
+        if(jack_ringbuffer_write_space(bridge->ring) / sizeof(float) < bridge->source_buffer_size) {
+            jack_ringbuffer_read_advance(bridge->ring, bridge_get_fill(bridge) * sizeof(float));
+            fill = 0;
+        }
+        double target_fill = bridge_get_target_fill(bridge);
+        if(fill < target_fill) {
+            memset(samples, 0, nframes * sizeof(float));
+            return;
+        }
+        // Start right at the targeted fill level with the drift unknown.
+        size_t excess = (size_t)(fill - target_fill);
+        jack_ringbuffer_read_advance(bridge->ring, excess * sizeof(float));
+        fill -= excess;
+        __atomic_store_n(&bridge->primed, 1, __ATOMIC_RELEASE);
+        bridge->filtered_fill = fill;
+        bridge->drift = 0;
+        bridge->phase = 1.0;
+        bridge->previous_sample = 0;
+        bridge->current_sample = 0;
+    }
+    bridge_update_ratio(bridge, fill);
+
+    jack_ringbuffer_data_t vector[2];
+    jack_ringbuffer_get_read_vector(bridge->ring, vector);
+    const float* first = (const float*) vector[0].buf;
+    const float* second = (const float*) vector[1].buf;
+    size_t first_length = vector[0].len / sizeof(float);
+    size_t available = first_length + vector[1].len / sizeof(float);
+
+    // Linear interpolation between consecutive input samples.
+    size_t consumed = 0;
+    jack_nframes_t frame;
+    for(frame = 0; frame < nframes; frame++) {
+        while(bridge->phase >= 1.0) {
+            if(consumed == available) {
+                break;
+            }
+            bridge->previous_sample = bridge->current_sample;
+            bridge->current_sample = consumed < first_length
+                ? first[consumed] : second[consumed - first_length];
+            consumed++;
+            bridge->phase -= 1.0;
+        }
+        if(bridge->phase >= 1.0) {
+            // Ran dry: output silence and wait for the ring to fill up again.
+            memset(&samples[frame], 0, (nframes - frame) * sizeof(float));
+            bridge->underruns++;
+            __atomic_store_n(&bridge->primed, 0, __ATOMIC_RELEASE);
+            break;
+        }
+        samples[frame] = bridge->previous_sample
+            + (bridge->current_sample - bridge->previous_sample) * (float)bridge->phase;
+        bridge->phase += bridge->ratio;
+    }
+
+    jack_ringbuffer_read_advance(bridge->ring, consumed * sizeof(float));
+}
+
+static PyObject* bridge___new__(PyTypeObject* type, PyObject* args, PyObject* kwargs)
+{
+    Bridge* self = (Bridge*)type->tp_alloc(type, 0);
+
+    if(self) {
+        PyObject *source_client_python, *source_port_python;
+        PyObject *target_client_python, *target_port_python;
+        unsigned long latency = 0;
+        static char* kwlist[] = {
+            "source_client", "source_port", "target_client", "target_port", "latency", NULL
+            };
+        // The object’s reference count is not increased.
+        if(!PyArg_ParseTupleAndKeywords(
+                    args, kwargs, "O!O!O!O!|k", kwlist,
+                    &client_type, &source_client_python, &port_type, &source_port_python,
+                    &client_type, &target_client_python, &port_type, &target_port_python,
+                    &latency
+                    )) {
+            Py_DECREF(self);
+            return NULL;
+        }
+
+        Client* source_client = (Client*)source_client_python;
+        Port* source_port = (Port*)source_port_python;
+        Client* target_client = (Client*)target_client_python;
+        Port* target_port = (Port*)target_port_python;
+        if(!jack_port_is_mine(source_client->client, source_port->port)
+                || !jack_port_is_mine(target_client->client, target_port->port)) {
+            PyErr_SetString(PyExc_ValueError, "Ports must be registered by the given clients.");
+            Py_DECREF(self);
+            return NULL;
+        }
+        if(!(jack_port_flags(source_port->port) & JackPortIsInput)
+                || !(jack_port_flags(target_port->port) & JackPortIsOutput)) {
+            PyErr_SetString(PyExc_ValueError, "Source port must be an input, target port an output.");
+            Py_DECREF(self);
+            return NULL;
+        }
+        if(strcmp(jack_port_type(source_port->port), JACK_DEFAULT_AUDIO_TYPE)
+                || strcmp(jack_port_type(target_port->port), JACK_DEFAULT_AUDIO_TYPE)) {
+            PyErr_SetString(PyExc_ValueError, "Only audio ports can be bridged.");
+            Py_DECREF(self);
+            return NULL;
+        }
+
+        jack_nframes_t source_buffer_size = jack_get_buffer_size(source_client->client);
+        jack_nframes_t target_buffer_size = jack_get_buffer_size(target_client->client);
+        if(!latency) {
+            // Right before the target reads, the ring holds about half a period of each server less
+            // than on average. It still has to cover a whole target period plus scheduling jitter.
+            latency = 3 * (source_buffer_size > target_buffer_size ? source_buffer_size : target_buffer_size);
+        }
+        self->latency = latency;
+        self->source_buffer_size = source_buffer_size;
+        self->source_sample_rate = jack_get_sample_rate(source_client->client);
+        // About one second.
+        self->settling_cycles = (double)jack_get_sample_rate(target_client->client) / target_buffer_size;
+
+        Py_INCREF(source_client);
+        self->source_client = source_client;
+        Py_INCREF(source_port);
+        self->source_port = source_port;
+        Py_INCREF(target_client);
+        self->target_client = target_client;
+        Py_INCREF(target_port);
+        self->target_port = target_port;
+
+        // Leave room for a full period of both servers on top of the targeted fill level
+        // and for the deviation while the controller settles.
+        self->ring = client_ringbuffer_create(
+                source_client,
+                (2 * latency + 2 * source_buffer_size + target_buffer_size) * sizeof(float)
+                );
+        if(!self->ring) {
+            Py_DECREF(self);
+            return NULL;
+        }
+
+        self->nominal_ratio = (double)jack_get_sample_rate(source_client->client)
+            / jack_get_sample_rate(target_client->client);
+        self->ratio = self->nominal_ratio;
+        self->samples_per_cycle = self->nominal_ratio * target_buffer_size;
+
+        self->target_processor.process = bridge_process_target;
+        self->target_processor.name = "jack.Bridge target";
+        if(client_attach_processor(target_client, &self->target_processor)) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        self->source_processor.process = bridge_process_source;
+        self->source_processor.name = "jack.Bridge source";
+        if(client_attach_processor(source_client, &self->source_processor)) {
+            Py_DECREF(self);
+            return NULL;
+        }
+    }
+
+    return (PyObject*)self;
+}
+
+static PyObject* python_bridge_get_fill(Bridge* self)
+{
+    return PyInt_FromSize_t(bridge_get_fill(self));
+}
+
+static PyObject* bridge_get_latency(Bridge* self)
+{
+    return PyInt_FromSize_t(self->latency);
+}
+
+static PyObject* bridge_get_ratio(Bridge* self)
+{
+    return PyFloat_FromDouble(self->ratio);
+}
+
+static PyObject* bridge_get_underruns(Bridge* self)
+{
+    return PyLong_FromUnsignedLong(self->underruns);
+}
+
+static PyObject* bridge_get_overruns(Bridge* self)
+{
+    return PyLong_FromUnsignedLong(self->overruns);
+}
+
+static void bridge_dealloc(Bridge* self)
+{
+    if(self->source_client) {
+        client_detach_processor(self->source_client, &self->source_processor);
+    }
+    if(self->target_client) {
+        client_detach_processor(self->target_client, &self->target_processor);
+    }
+    if(self->ring) {
+        client_release(self->source_client, self->ring);
+    }
+
+    Py_XDECREF(self->source_client);
+    Py_XDECREF(self->source_port);
+    Py_XDECREF(self->target_client);
+    Py_XDECREF(self->target_port);
+
+    self->ob_type->tp_free((PyObject*)self);
+}
+
+static PyMethodDef bridge_methods[] = {
+    {
+        "get_fill",
+        (PyCFunction)python_bridge_get_fill,
+        METH_NOARGS,
+        "Return number of samples currently buffered between both servers.",
+        },
+    {
+        "get_latency",
+        (PyCFunction)bridge_get_latency,
+        METH_NOARGS,
+        "Return number of samples the bridge tries to keep buffered.",
+        },
+    {
+        "get_ratio",
+        (PyCFunction)bridge_get_ratio,
+        METH_NOARGS,
+        "Return current resampling ratio (source samples per target sample).",
+        },
+    {
+        "get_underruns",
+        (PyCFunction)bridge_get_underruns,
+        METH_NOARGS,
+        "Return number of target cycles that ran out of buffered samples.",
+        },
+    {
+        "get_overruns",
+        (PyCFunction)bridge_get_overruns,
+        METH_NOARGS,
+        "Return number of source cycles that had to drop samples.",
+        },
+    {NULL},
+    };
+
+// Layout of the memory exported by jack.SharedMemoryTap, in native byte order.
+// The header is followed by one ring of `capacity` float samples per channel,
+// starting at `data_offset`. Sample number n of a channel is stored at index n % capacity.
+// Samples before `position` are complete. Readers copying within a period may follow the
+// seqlock protocol: read an even `sequence`, copy the samples and accept the copy only if
+// `sequence` is still unchanged. Slower readers re-read `position` after copying instead:
+// sample n is intact while `position` plus one period has not passed n + capacity.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t channel_count;
+    uint32_t sample_rate;
+    uint64_t capacity;
+    uint64_t data_offset;
+    // Odd while the process thread is writing.
+    uint64_t sequence;
+    // Number of samples written per channel since the tap was created.
+    uint64_t position;
+} shared_memory_header;
+
+#ifdef __linux__
+// glibc only declares memfd_create() and the sealing constants since 2.27.
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS (1024 + 9)
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+#ifndef SYS_memfd_create
+#if defined(__x86_64__)
+#define SYS_memfd_create 319
+#elif defined(__i386__)
+#define SYS_memfd_create 356
+#elif defined(__aarch64__)
+#define SYS_memfd_create 279
+#elif defined(__arm__)
+#define SYS_memfd_create 385
+#endif
+#endif
+#endif
+
+static const uint32_t shared_memory_magic = 0x5054434a; // "JCTP"
+static const uint32_t shared_memory_version = 1;
+
+typedef struct {
+    PyObject_HEAD
+    Client* client;
+    PyObject* ports;
+    jack_port_t** jack_ports;
+    processor tap_processor;
+    int fd;
+    size_t size;
+    shared_memory_header* header;
+    float* data;
+} SharedMemoryTap;
+
+// Return a file descriptor of new anonymous shared memory or -1 with errno set.
+static int shared_memory_create(const char* name)
+{
+#if defined(__linux__) && defined(SYS_memfd_create)
+    return syscall(SYS_memfd_create, name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+    // POSIX shared memory, unlinked right away so only the descriptor refers to it.
+    // Names are kept short for systems limiting them to 31 characters.
+    static unsigned int last_index;
+    char path[32];
+    snprintf(
+        path, sizeof(path), "/jack.%d.%u",
+        (int)getpid(), __atomic_add_fetch(&last_index, 1, __ATOMIC_RELAXED)
+        );
+    int fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd >= 0) {
+        shm_unlink(path);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    return fd;
+#endif
+}
+
+static void shared_memory_tap_process(processor* p, jack_nframes_t nframes)
+{
+    SharedMemoryTap* tap = container_of(p, SharedMemoryTap, tap_processor);
+    shared_memory_header* header = tap->header;
+
+    uint64_t sequence = header->sequence;
+    __atomic_store_n(&header->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    // The buffer size may have grown past the capacity since the tap was created.
+    // Only keep the latest samples then, as they would overwrite the others anyway.
+    size_t skipped = nframes > header->capacity ? nframes - header->capacity : 0;
+    size_t count = nframes - skipped;
+    size_t offset = (header->position + skipped) % header->capacity;
+    size_t first_count = header->capacity - offset;
+    if(first_count > count) {
+        first_count = count;
+    }
+    uint32_t channel_index;
+    for(channel_index = 0; channel_index < header->channel_count; channel_index++) {
+        const float* samples = (const float*) jack_port_get_buffer(tap->jack_ports[channel_index], nframes);
+        float* ring = tap->data + channel_index * header->capacity;
+        memcpy(ring + offset, samples + skipped, first_count * sizeof(float));
+        memcpy(ring, samples + skipped + first_count, (count - first_count) * sizeof(float));
+    }
+
+    __atomic_store_n(&header->position, header->position + nframes, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+static PyObject* shared_memory_tap___new__(PyTypeObject* type, PyObject* args, PyObject* kwargs)
+{
+    SharedMemoryTap* self = (SharedMemoryTap*)type->tp_alloc(type, 0);
+
+    if(self) {
+        self->fd = -1;
+
+        PyObject* client_python;
+        PyObject* ports;
+        unsigned long capacity = 0;
+        static char* kwlist[] = {"client", "ports", "capacity", NULL};
+        // The object’s reference count is not increased.
+        if(!PyArg_ParseTupleAndKeywords(
+                    args, kwargs, "O!O|k", kwlist,
+                    &client_type, &client_python, &ports, &capacity
+                    )) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        Client* client = (Client*)client_python;
+        Py_INCREF(client);
+        self->client = client;
+
+        self->ports = PySequence_Tuple(ports);
+        if(!self->ports) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        Py_ssize_t channel_count = PyTuple_GET_SIZE(self->ports);
+        if(channel_count == 0) {
+            PyErr_SetString(PyExc_ValueError, "At least one port is required.");
+            Py_DECREF(self);
+            return NULL;
+        }
+        self->jack_ports = (jack_port_t**) client_allocate(client, channel_count * sizeof(jack_port_t*));
+        if(!self->jack_ports) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        Py_ssize_t channel_index;
+        for(channel_index = 0; channel_index < channel_count; channel_index++) {
+            PyObject* port = PyTuple_GET_ITEM(self->ports, channel_index);
+            if(!PyObject_TypeCheck(port, &port_type)) {
+                PyErr_SetString(PyExc_TypeError, "Ports must be of type jack.Port.");
+                Py_DECREF(self);
+                return NULL;
+            }
+            jack_port_t* jack_port = ((Port*)port)->port;
+            if(!jack_port_is_mine(client->client, jack_port)) {
+                PyErr_SetString(PyExc_ValueError, "Ports must be registered by the given client.");
+                Py_DECREF(self);
+                return NULL;
+            }
+            if(strcmp(jack_port_type(jack_port), JACK_DEFAULT_AUDIO_TYPE)) {
+                PyErr_SetString(PyExc_ValueError, "Only audio ports can be tapped.");
+                Py_DECREF(self);
+                return NULL;
+            }
+            self->jack_ports[channel_index] = jack_port;
+        }
+
+        jack_nframes_t buffer_size = jack_get_buffer_size(client->client);
+        if(!capacity) {
+            capacity = jack_get_sample_rate(client->client);
+        }
+        if(capacity < 2 * buffer_size) {
+            PyErr_SetString(PyExc_ValueError, "Capacity must cover at least two periods.");
+            Py_DECREF(self);
+            return NULL;
+        }
+
+        self->fd = shared_memory_create("jack.SharedMemoryTap");
+        if(self->fd < 0) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            Py_DECREF(self);
+            return NULL;
+        }
+        size_t data_offset = 64;
+        self->size = data_offset + channel_count * capacity * sizeof(float);
+        if(ftruncate(self->fd, self->size)
+#ifdef __linux__
+                // Readers must not be able to resize the memory under the process thread.
+                || fcntl(self->fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)
+#endif
+                ) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            Py_DECREF(self);
+            return NULL;
+        }
+        void* memory = mmap(NULL, self->size, PROT_READ | PROT_WRITE, MAP_SHARED, self->fd, 0);
+        if(memory == MAP_FAILED) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            Py_DECREF(self);
+            return NULL;
+        }
+        // Fault in all pages now rather than in the process thread.
+        memset(memory, 0, self->size);
+        mlock(memory, self->size);
+        self->header = (shared_memory_header*)memory;
+        self->data = (float*)((char*)memory + data_offset);
+
+        self->header->magic = shared_memory_magic;
+        self->header->version = shared_memory_version;
+        self->header->channel_count = channel_count;
+        self->header->sample_rate = jack_get_sample_rate(client->client);
+        self->header->capacity = capacity;
+        self->header->data_offset = data_offset;
+
+        self->tap_processor.process = shared_memory_tap_process;
+        self->tap_processor.name = "jack.SharedMemoryTap";
+        if(client_attach_processor(client, &self->tap_processor)) {
+            Py_DECREF(self);
+            return NULL;
+        }
+    }
+
+    return (PyObject*)self;
+}
+
+static PyObject* shared_memory_tap_fileno(SharedMemoryTap* self)
+{
+    return PyInt_FromLong(self->fd);
+}
+
+static PyObject* shared_memory_tap_get_size(SharedMemoryTap* self)
+{
+    return PyInt_FromSize_t(self->size);
+}
+
+static PyObject* shared_memory_tap_get_capacity(SharedMemoryTap* self)
+{
+    return PyInt_FromSize_t(self->header->capacity);
+}
+
+static PyObject* shared_memory_tap_get_ports(SharedMemoryTap* self)
+{
+    return PySequence_List(self->ports);
+}
+
+static void shared_memory_tap_dealloc(SharedMemoryTap* self)
+{
+    if(self->client) {
+        client_detach_processor(self->client, &self->tap_processor);
+    }
+    if(self->header) {
+        munmap(self->header, self->size);
+    }
+    if(self->fd >= 0) {
+        close(self->fd);
+    }
+    if(self->jack_ports) {
+        client_release(self->client, self->jack_ports);
+    }
+
+    Py_XDECREF(self->client);
+    Py_XDECREF(self->ports);
+
+    self->ob_type->tp_free((PyObject*)self);
+}
+
+static PyMethodDef shared_memory_tap_methods[] = {
+    {
+        "fileno",
+        (PyCFunction)shared_memory_tap_fileno,
+        METH_NOARGS,
+        "Return file descriptor of the shared memory. Other processes may map it via /proc/<pid>/fd/<fd>.",
+        },
+    {
+        "get_size",
+        (PyCFunction)shared_memory_tap_get_size,
+        METH_NOARGS,
+        "Return size of the shared memory in bytes.",
+        },
+    {
+        "get_capacity",
+        (PyCFunction)shared_memory_tap_get_capacity,
+        METH_NOARGS,
+        "Return number of samples kept per channel.",
+        },
+    {
+        "get_ports",
+        (PyCFunction)shared_memory_tap_get_ports,
+        METH_NOARGS,
+        "Return list of tapped ports in channel order.",
+        },
+    {NULL},
+    };
+
+typedef struct {
+    PyObject_HEAD
+    Client* client;
+    Port* port;
+    processor analyzer_processor;
+    // Samples from the process thread to the helper thread.
+    jack_ringbuffer_t* ring;
+    sem_t samples_available;
+    unsigned char semaphore_initialized;
+    pthread_t thread;
+    unsigned char thread_started;
+    int running;
+    size_t size;
+    size_t hop;
+    // Helper thread only.
+    float* input;
+    size_t input_fill;
+    float* window;
+    float window_gain;
+    float* real;
+    float* imaginary;
+    float* cosine;
+    float* sine;
+    // Double buffer of magnitude spectra with one seqlock per slot.
+    // The helper thread always writes into the slot not published last.
+    float* spectra[2];
+    unsigned int sequences[2];
+    int latest;
+    unsigned long spectrum_count;
+    unsigned long overruns;
+} SpectrumAnalyzer;
+
+static void spectrum_analyzer_process(processor* p, jack_nframes_t nframes)
+{
+    SpectrumAnalyzer* analyzer = container_of(p, SpectrumAnalyzer, analyzer_processor);
+
+    const float* samples = (const float*) jack_port_get_buffer(analyzer->port->port, nframes);
+    if(jack_ringbuffer_write_space(analyzer->ring) < nframes * sizeof(float)) {
+        analyzer->overruns++;
+    } else {
+        jack_ringbuffer_write(analyzer->ring, (const char*)samples, nframes * sizeof(float));
     }
-    if(terminal) {
-        flags |= JackPortIsTerminal;
+    // Unlike condition variables, semaphores can be posted without taking a lock.
+    sem_post(&analyzer->samples_available);
+}
+
+// In-place iterative radix-2 decimation-in-time FFT.
+static void fft(float* real, float* imaginary, const float* cosine, const float* sine, size_t size)
+{
+    size_t i, j = 0;
+    for(i = 1; i < size; i++) {
+        size_t bit = size >> 1;
+        for(; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if(i < j) {
+            float swap = real[i];
+            real[i] = real[j];
+            real[j] = swap;
+            swap = imaginary[i];
+            imaginary[i] = imaginary[j];
+            imaginary[j] = swap;
+        }
     }
 
-    Port* port = PyObject_New(Port, &port_type);
-    port->port = jack_port_register(
-            self->client,
-            name,
-            type,
-            flags,
-            64
-            );
-    if(!port->port) {
-        PyErr_SetString(error, "Could not register port.");
-        return NULL;
+    size_t length;
+    for(length = 2; length <= size; length <<= 1) {
+        size_t half = length >> 1;
+        size_t step = size / length;
+        for(i = 0; i < size; i += length) {
+            size_t k;
+            for(k = 0; k < half; k++) {
+                float twiddle_real = cosine[k * step];
+                float twiddle_imaginary = -sine[k * step];
+                size_t a = i + k;
+                size_t b = a + half;
+                float product_real = real[b] * twiddle_real - imaginary[b] * twiddle_imaginary;
+                float product_imaginary = real[b] * twiddle_imaginary + imaginary[b] * twiddle_real;
+                real[b] = real[a] - product_real;
+                imaginary[b] = imaginary[a] - product_imaginary;
+                real[a] += product_real;
+                imaginary[a] += product_imaginary;
+            }
+        }
     }
-    return (PyObject*)port;
 }
 
-static PyObject* client_set_port_registered_callback(Client* self, PyObject* args)
+static void spectrum_analyzer_analyze(SpectrumAnalyzer* analyzer)
 {
-    PyObject* callback = 0;
-    PyObject* callback_argument = 0;
-    if(!PyArg_ParseTuple(args, "O|O", &callback, &callback_argument)) {
-        return NULL;
+    size_t i;
+    for(i = 0; i < analyzer->size; i++) {
+        analyzer->real[i] = analyzer->input[i] * analyzer->window[i];
+        analyzer->imaginary[i] = 0;
     }
-    if(!PyCallable_Check(callback)) {
-        PyErr_SetString(PyExc_TypeError, "Parameter must be callable.");
-        return NULL;
+    fft(analyzer->real, analyzer->imaginary, analyzer->cosine, analyzer->sine, analyzer->size);
+
+    int slot = analyzer->latest == 0 ? 1 : 0;
+    float* spectrum = analyzer->spectra[slot];
+    __atomic_store_n(&analyzer->sequences[slot], analyzer->sequences[slot] + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for(i = 0; i <= analyzer->size / 2; i++) {
+        spectrum[i] = sqrtf(analyzer->real[i] * analyzer->real[i] + analyzer->imaginary[i] * analyzer->imaginary[i])
+            * analyzer->window_gain;
     }
+    // DC and Nyquist have no negative frequency counterpart, so they must not be doubled.
+    spectrum[0] *= 0.5f;
+    spectrum[analyzer->size / 2] *= 0.5f;
+    __atomic_store_n(&analyzer->sequences[slot], analyzer->sequences[slot] + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&analyzer->latest, slot, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&analyzer->spectrum_count, 1, __ATOMIC_RELAXED);
+}
 
-    Py_XINCREF(callback);
-    Py_XDECREF(self->port_registered_callback);
-    self->port_registered_callback = callback;
-
-    Py_XINCREF(callback_argument);
-    Py_XDECREF(self->port_registered_callback_argument);
-    self->port_registered_callback_argument = callback_argument;
+static void* spectrum_analyzer_thread(void* arg)
+{
+    SpectrumAnalyzer* analyzer = (SpectrumAnalyzer*)arg;
+
+    while(__atomic_load_n(&analyzer->running, __ATOMIC_ACQUIRE)) {
+        sem_wait(&analyzer->samples_available);
+        while(jack_ringbuffer_read_space(analyzer->ring) >= analyzer->hop * sizeof(float)) {
+            // Slide the window by one hop.
+            memmove(
+                analyzer->input,
+                analyzer->input + analyzer->hop,
+                (analyzer->size - analyzer->hop) * sizeof(float)
+                );
+            jack_ringbuffer_read(
+                analyzer->ring,
+                (char*)(analyzer->input + analyzer->size - analyzer->hop),
+                analyzer->hop * sizeof(float)
+                );
+            if(analyzer->input_fill < analyzer->size) {
+                analyzer->input_fill += analyzer->hop;
+            }
+            if(analyzer->input_fill >= analyzer->size) {
+                spectrum_analyzer_analyze(analyzer);
+            }
+        }
+    }
 
-    Py_INCREF(Py_None);
-    return Py_None;
+    return NULL;
 }
 
-static PyObject* client_set_port_unregistered_callback(Client* self, PyObject* args)
+static PyObject* spectrum_analyzer___new__(PyTypeObject* type, PyObject* args, PyObject* kwargs)
 {
-    PyObject* callback = 0;
-    PyObject* callback_argument = 0;
-    if(!PyArg_ParseTuple(args, "O|O", &callback, &callback_argument)) {
-        return NULL;
-    }
-    if(!PyCallable_Check(callback)) {
-        PyErr_SetString(PyExc_TypeError, "Parameter must be callable.");
-        return NULL;
-    }
+    SpectrumAnalyzer* self = (SpectrumAnalyzer*)type->tp_alloc(type, 0);
 
-    Py_XINCREF(callback);
-    Py_XDECREF(self->port_unregistered_callback);
-    self->port_unregistered_callback = callback;
+    if(self) {
+        self->latest = -1;
 
-    Py_XINCREF(callback_argument);
-    Py_XDECREF(self->port_unregistered_callback_argument);
-    self->port_unregistered_callback_argument = callback_argument;
+        PyObject *client_python, *port_python;
+        unsigned long size = 1024;
+        double overlap = 0.5;
+        static char* kwlist[] = {"client", "port", "size", "overlap", NULL};
+        // The object’s reference count is not increased.
+        if(!PyArg_ParseTupleAndKeywords(
+                    args, kwargs, "O!O!|kd", kwlist,
+                    &client_type, &client_python, &port_type, &port_python,
+                    &size, &overlap
+                    )) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        Client* client = (Client*)client_python;
+        Port* port = (Port*)port_python;
 
-    Py_INCREF(Py_None);
-    return Py_None;
-}
+        if(!jack_port_is_mine(client->client, port->port)) {
+            PyErr_SetString(PyExc_ValueError, "Port must be registered by the given client.");
+            Py_DECREF(self);
+            return NULL;
+        }
+        if(!(jack_port_flags(port->port) & JackPortIsInput)
+                || strcmp(jack_port_type(port->port), JACK_DEFAULT_AUDIO_TYPE)) {
+            PyErr_SetString(PyExc_ValueError, "Only audio input ports can be analyzed.");
+            Py_DECREF(self);
+            return NULL;
+        }
+        if(size < 2 || (size & (size - 1))) {
+            PyErr_SetString(PyExc_ValueError, "Size must be a power of two.");
+            Py_DECREF(self);
+            return NULL;
+        }
+        if(overlap < 0 || overlap >= 1) {
+            PyErr_SetString(PyExc_ValueError, "Overlap must be at least 0 and less than 1.");
+            Py_DECREF(self);
+            return NULL;
+        }
+        self->size = size;
+        self->hop = size - (size_t)(overlap * size);
+        if(self->hop < 1) {
+            self->hop = 1;
+        }
 
-static PyObject* client_set_port_renamed_callback(Client* self, PyObject* args)
-{
-    PyObject* callback = 0;
-    PyObject* callback_argument = 0;
-    if(!PyArg_ParseTuple(args, "O|O", &callback, &callback_argument)) {
-        return NULL;
-    }
-    if(!PyCallable_Check(callback)) {
-        PyErr_SetString(PyExc_TypeError, "Parameter must be callable.");
-        return NULL;
-    }
+        Py_INCREF(client);
+        self->client = client;
+        self->ring = client_ringbuffer_create(client, 4 * (size + jack_get_buffer_size(client->client)) * sizeof(float));
+        if(!self->ring) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        self->input = (float*) calloc(size, sizeof(float));
+        self->window = (float*) malloc(size * sizeof(float));
+        self->real = (float*) malloc(size * sizeof(float));
+        self->imaginary = (float*) malloc(size * sizeof(float));
+        self->cosine = (float*) malloc(size / 2 * sizeof(float));
+        self->sine = (float*) malloc(size / 2 * sizeof(float));
+        self->spectra[0] = (float*) calloc(size / 2 + 1, sizeof(float));
+        self->spectra[1] = (float*) calloc(size / 2 + 1, sizeof(float));
+        if(!self->input || !self->window || !self->real || !self->imaginary
+                || !self->cosine || !self->sine || !self->spectra[0] || !self->spectra[1]) {
+            Py_DECREF(self);
+            return PyErr_NoMemory();
+        }
 
-    Py_XINCREF(callback);
-    Py_XDECREF(self->port_renamed_callback);
-    self->port_renamed_callback = callback;
+        // Hann window, scaled so that a full scale sine peaks at about 1.
+        double window_sum = 0;
+        size_t i;
+        for(i = 0; i < size; i++) {
+            self->window[i] = 0.5 - 0.5 * cos(2 * M_PI * i / size);
+            window_sum += self->window[i];
+        }
+        self->window_gain = 2 / window_sum;
+        for(i = 0; i < size / 2; i++) {
+            self->cosine[i] = cos(2 * M_PI * i / size);
+            self->sine[i] = sin(2 * M_PI * i / size);
+        }
 
-    Py_XINCREF(callback_argument);
-    Py_XDECREF(self->port_renamed_callback_argument);
-    self->port_renamed_callback_argument = callback_argument;
+        if(sem_init(&self->samples_available, 0, 0)) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            Py_DECREF(self);
+            return NULL;
+        }
+        self->semaphore_initialized = 1;
+        self->running = 1;
+        if(pthread_create(&self->thread, NULL, spectrum_analyzer_thread, self)) {
+            PyErr_SetString(error, "Could not start analyzer thread.");
+            Py_DECREF(self);
+            return NULL;
+        }
+        self->thread_started = 1;
 
-    Py_INCREF(Py_None);
-    return Py_None;
+        Py_INCREF(port);
+        self->port = port;
+
+        self->analyzer_processor.process = spectrum_analyzer_process;
+        self->analyzer_processor.name = "jack.SpectrumAnalyzer";
+        if(client_attach_processor(client, &self->analyzer_processor)) {
+            Py_DECREF(self);
+            return NULL;
+        }
+    }
+
+    return (PyObject*)self;
 }
 
-static PyObject* client_set_shutdown_callback(Client* self, PyObject* args)
+static PyObject* spectrum_analyzer_get_spectrum(SpectrumAnalyzer* self)
 {
-    PyObject* callback = 0;
-    PyObject* callback_argument = 0;
-    if(!PyArg_ParseTuple(args, "O|O", &callback, &callback_argument)) {
+    int slot = __atomic_load_n(&self->latest, __ATOMIC_ACQUIRE);
+    if(slot < 0) {
+        Py_INCREF(Py_None);
+        return Py_None;
+    }
+
+    size_t bins = self->size / 2 + 1;
+    PyObject* magnitudes = PyString_FromStringAndSize(NULL, bins * sizeof(float));
+    if(!magnitudes) {
         return NULL;
     }
-    if(!PyCallable_Check(callback)) {
-        PyErr_SetString(PyExc_TypeError, "Parameter must be callable.");
+    while(1) {
+        unsigned int sequence = __atomic_load_n(&self->sequences[slot], __ATOMIC_ACQUIRE);
+        if(sequence % 2 == 0) {
+            memcpy(PyString_AS_STRING(magnitudes), self->spectra[slot], bins * sizeof(float));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if(__atomic_load_n(&self->sequences[slot], __ATOMIC_RELAXED) == sequence) {
+                break;
+            }
+        }
+        // The helper thread published twice meanwhile.
+        slot = __atomic_load_n(&self->latest, __ATOMIC_ACQUIRE);
+    }
+
+    // array.array supports the buffer protocol, e.g. numpy.frombuffer(spectrum, dtype = numpy.float32)
+    PyObject* array = python_import("array");
+    if(!array) {
+        Py_DECREF(magnitudes);
         return NULL;
     }
+    PyObject* spectrum = PyObject_CallMethod(array, "array", "sO", "f", magnitudes);
+    Py_DECREF(array);
+    Py_DECREF(magnitudes);
+    return spectrum;
+}
 
-    Py_XINCREF(callback);
-    Py_XDECREF(self->shutdown_callback);
-    self->shutdown_callback = callback;
+static PyObject* spectrum_analyzer_get_size(SpectrumAnalyzer* self)
+{
+    return PyInt_FromSize_t(self->size);
+}
 
-    Py_XINCREF(callback_argument);
-    Py_XDECREF(self->shutdown_callback_argument);
-    self->shutdown_callback_argument = callback_argument;
+static PyObject* spectrum_analyzer_get_hop(SpectrumAnalyzer* self)
+{
+    return PyInt_FromSize_t(self->hop);
+}
 
-    Py_INCREF(Py_None);
-    return Py_None;
+static PyObject* spectrum_analyzer_get_spectrum_count(SpectrumAnalyzer* self)
+{
+    return PyLong_FromUnsignedLong(__atomic_load_n(&self->spectrum_count, __ATOMIC_RELAXED));
 }
 
-static void client_dealloc(Client* self)
+static PyObject* spectrum_analyzer_get_overruns(SpectrumAnalyzer* self)
 {
-    jack_client_close(self->client);
+    return PyLong_FromUnsignedLong(self->overruns);
+}
 
-    Py_XDECREF(self->port_registered_callback);
-    Py_XDECREF(self->port_registered_callback_argument);
-    Py_XDECREF(self->port_renamed_callback);
-    Py_XDECREF(self->port_renamed_callback_argument);
-    Py_XDECREF(self->port_unregistered_callback);
-    Py_XDECREF(self->port_unregistered_callback_argument);
-    Py_XDECREF(self->shutdown_callback);
-    Py_XDECREF(self->shutdown_callback_argument);
+static void spectrum_analyzer_dealloc(SpectrumAnalyzer* self)
+{
+    if(self->client) {
+        client_detach_processor(self->client, &self->analyzer_processor);
+    }
+    if(self->thread_started) {
+        __atomic_store_n(&self->running, 0, __ATOMIC_RELEASE);
+        sem_post(&self->samples_available);
+        pthread_join(self->thread, NULL);
+    }
+    if(self->semaphore_initialized) {
+        sem_destroy(&self->samples_available);
+    }
+    if(self->ring) {
+        client_release(self->client, self->ring);
+    }
+    free(self->input);
+    free(self->window);
+    free(self->real);
+    free(self->imaginary);
+    free(self->cosine);
+    free(self->sine);
+    free(self->spectra[0]);
+    free(self->spectra[1]);
+
+    Py_XDECREF(self->client);
+    Py_XDECREF(self->port);
 
     self->ob_type->tp_free((PyObject*)self);
 }
 
-static PyMethodDef client_methods[] = {
+static PyMethodDef spectrum_analyzer_methods[] = {
     {
-        "activate",
-        (PyCFunction)client_activate,
+        "get_spectrum",
+        (PyCFunction)spectrum_analyzer_get_spectrum,
         METH_NOARGS,
-        "Tell the Jack server that the program is ready to start processing audio.",
+        "Return latest magnitude spectrum as array of size / 2 + 1 floats or None if there is none yet.",
         },
     {
-        "connect",
-        (PyCFunction)client_connect,
-        METH_VARARGS,
-        "Establish a connection between two ports.",
+        "get_size",
+        (PyCFunction)spectrum_analyzer_get_size,
+        METH_NOARGS,
+        "Return number of samples per transform.",
         },
     {
-        "deactivate",
-        (PyCFunction)client_deactivate,
+        "get_hop",
+        (PyCFunction)spectrum_analyzer_get_hop,
         METH_NOARGS,
-        "Tell the Jack server that the program is ready to start processing audio.",
+        "Return number of samples between the starts of consecutive transforms.",
         },
     {
-        "get_name",
-        (PyCFunction)client_get_name,
+        "get_spectrum_count",
+        (PyCFunction)spectrum_analyzer_get_spectrum_count,
         METH_NOARGS,
-        "Return client's actual name.",
+        "Return number of spectra computed so far.",
         },
     {
-        "get_ports",
-        (PyCFunction)client_get_ports,
+        "get_overruns",
+        (PyCFunction)spectrum_analyzer_get_overruns,
         METH_NOARGS,
-        "Return list of ports.",
+        "Return number of cycles dropped because the analyzer thread fell behind.",
         },
-    {
-        "register_port",
-        (PyCFunction)client_register_port,
-        METH_VARARGS | METH_KEYWORDS,
-        "Register a new port for the client.",
+    {NULL},
+    };
+
+typedef struct {
+    PyObject_HEAD
+    Client* client;
+    Port* port;
+    processor oscillator_processor;
+    // Set from Python at any time, picked up by the next cycle.
+    double frequency;
+    float amplitude;
+    float offset;
+    // Process thread only, in periods.
+    double phase;
+} Oscillator;
+
+static void oscillator_process(processor* p, jack_nframes_t nframes)
+{
+    Oscillator* oscillator = container_of(p, Oscillator, oscillator_processor);
+
+    double frequency;
+    float amplitude, offset;
+    __atomic_load(&oscillator->frequency, &frequency, __ATOMIC_RELAXED);
+    __atomic_load(&oscillator->amplitude, &amplitude, __ATOMIC_RELAXED);
+    __atomic_load(&oscillator->offset, &offset, __ATOMIC_RELAXED);
+
+    float* samples = (float*) jack_port_get_buffer(oscillator->port->port, nframes);
+    // The phase carries over, so changing the frequency does not click.
+    double increment = frequency / jack_get_sample_rate(oscillator->client->client);
+    jack_nframes_t frame;
+    for(frame = 0; frame < nframes; frame++) {
+        samples[frame] = offset + amplitude * (float)sin(2 * M_PI * oscillator->phase);
+        oscillator->phase += increment;
+    }
+    oscillator->phase -= floor(oscillator->phase);
+}
+
+static PyObject* oscillator___new__(PyTypeObject* type, PyObject* args, PyObject* kwargs)
+{
+    Oscillator* self = (Oscillator*)type->tp_alloc(type, 0);
+
+    if(self) {
+        PyObject *client_python, *port_python;
+        double frequency = 1000;
+        float amplitude = 1;
+        float offset = 0;
+        static char* kwlist[] = {"client", "port", "frequency", "amplitude", "offset", NULL};
+        // The object’s reference count is not increased.
+        if(!PyArg_ParseTupleAndKeywords(
+                    args, kwargs, "O!O!|dff", kwlist,
+                    &client_type, &client_python, &port_type, &port_python,
+                    &frequency, &amplitude, &offset
+                    )) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        Client* client = (Client*)client_python;
+        Port* port = (Port*)port_python;
+
+        if(!jack_port_is_mine(client->client, port->port)) {
+            PyErr_SetString(PyExc_ValueError, "Port must be registered by the given client.");
+            Py_DECREF(self);
+            return NULL;
+        }
+        if(!(jack_port_flags(port->port) & JackPortIsOutput)
+                || strcmp(jack_port_type(port->port), JACK_DEFAULT_AUDIO_TYPE)) {
+            PyErr_SetString(PyExc_ValueError, "Only audio output ports can be driven.");
+            Py_DECREF(self);
+            return NULL;
+        }
+        self->frequency = frequency;
+        self->amplitude = amplitude;
+        self->offset = offset;
+
+        Py_INCREF(client);
+        self->client = client;
+        Py_INCREF(port);
+        self->port = port;
+
+        self->oscillator_processor.process = oscillator_process;
+        self->oscillator_processor.name = "jack.Oscillator";
+        if(client_attach_processor(client, &self->oscillator_processor)) {
+            Py_DECREF(self);
+            return NULL;
+        }
+    }
+
+    return (PyObject*)self;
+}
+
+static PyObject* oscillator_get_frequency(Oscillator* self)
+{
+    return PyFloat_FromDouble(self->frequency);
+}
+
+static PyObject* oscillator_set_frequency(Oscillator* self, PyObject* args)
+{
+    double frequency;
+    if(!PyArg_ParseTuple(args, "d", &frequency)) {
+        return NULL;
+    }
+    __atomic_store(&self->frequency, &frequency, __ATOMIC_RELAXED);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* oscillator_get_amplitude(Oscillator* self)
+{
+    return PyFloat_FromDouble(self->amplitude);
+}
+
+static PyObject* oscillator_set_amplitude(Oscillator* self, PyObject* args)
+{
+    float amplitude;
+    if(!PyArg_ParseTuple(args, "f", &amplitude)) {
+        return NULL;
+    }
+    __atomic_store(&self->amplitude, &amplitude, __ATOMIC_RELAXED);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* oscillator_get_offset(Oscillator* self)
+{
+    return PyFloat_FromDouble(self->offset);
+}
+
+static PyObject* oscillator_set_offset(Oscillator* self, PyObject* args)
+{
+    float offset;
+    if(!PyArg_ParseTuple(args, "f", &offset)) {
+        return NULL;
+    }
+    __atomic_store(&self->offset, &offset, __ATOMIC_RELAXED);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static void oscillator_dealloc(Oscillator* self)
+{
+    if(self->client) {
+        client_detach_processor(self->client, &self->oscillator_processor);
+    }
+
+    Py_XDECREF(self->client);
+    Py_XDECREF(self->port);
+
+    self->ob_type->tp_free((PyObject*)self);
+}
+
+static PyMethodDef oscillator_methods[] = {
+    {
+        "get_frequency",
+        (PyCFunction)oscillator_get_frequency,
+        METH_NOARGS,
+        "Return frequency in Hz.",
         },
     {
-        "set_port_registered_callback",
-        (PyCFunction)client_set_port_registered_callback,
+        "set_frequency",
+        (PyCFunction)oscillator_set_frequency,
         METH_VARARGS,
-        "Tell the JACK server to call a function whenever a port is registered.",
+        "Change frequency in Hz, starting with the next cycle.",
         },
     {
-        "set_port_unregistered_callback",
-        (PyCFunction)client_set_port_unregistered_callback,
-        METH_VARARGS,
-        "Tell the JACK server to call a function whenever a port is unregistered.",
+        "get_amplitude",
+        (PyCFunction)oscillator_get_amplitude,
+        METH_NOARGS,
+        "Return peak level of the sine wave.",
         },
     {
-        "set_port_renamed_callback",
-        (PyCFunction)client_set_port_renamed_callback,
+        "set_amplitude",
+        (PyCFunction)oscillator_set_amplitude,
         METH_VARARGS,
-        "Tell the JACK server to call a function whenever a port is renamed.",
+        "Change peak level of the sine wave, starting with the next cycle.",
         },
     {
-        "set_shutdown_callback",
-        (PyCFunction)client_set_shutdown_callback,
+        "get_offset",
+        (PyCFunction)oscillator_get_offset,
+        METH_NOARGS,
+        "Return constant level added to the sine wave.",
+        },
+    {
+        "set_offset",
+        (PyCFunction)oscillator_set_offset,
         METH_VARARGS,
-        "Tell the JACK server to call a function when the server shuts down the client.",
+        "Change constant level added to the sine wave, starting with the next cycle.",
         },
     {NULL},
     };
 
-unsigned char port_is_input(const Port* port)
-{
-    return jack_port_flags(port->port) & JackPortIsInput;
-}
+const int ramp_step = 0;
+const int ramp_linear = 1;
+const int ramp_cosine = 2;
 
-static PyObject* python_port_is_input(Port* self)
-{
-    // The flags "JackPortIsInput" and "JackPortIsOutput" are mutually exclusive.
-    return (PyObject*)PyBool_FromLong(port_is_input(self));
-}
+typedef struct {
+    jack_nframes_t frame;
+    unsigned char immediate;
+    unsigned char ramp;
+    unsigned int parameter;
+    float value;
+    jack_nframes_t duration;
+} mixer_command;
 
-unsigned char port_is_output(const Port* port)
-{
-    return jack_port_flags(port->port) & JackPortIsOutput;
-}
+typedef struct {
+    float value;
+    float start;
+    float target;
+    unsigned char ramp;
+    jack_nframes_t position;
+    jack_nframes_t duration;
+} mixer_parameter;
 
-static PyObject* python_port_is_output(Port* self)
+typedef struct {
+    PyObject_HEAD
+    Client* client;
+    PyObject* inputs;
+    PyObject* outputs;
+    processor mixer_processor;
+    size_t input_count;
+    size_t output_count;
+    jack_port_t** jack_ports;
+    float** buffers;
+    // Routing matrix (output major), followed by the gain and the mute level of each output.
+    mixer_parameter* parameters;
+    size_t parameter_count;
+    // Indices of parameters with a ramp in progress.
+    unsigned int* ramps;
+    size_t ramp_count;
+    // Commands from Python to the process thread.
+    jack_ringbuffer_t* queue;
+    // Commands waiting for their frame, latest first.
+    mixer_command* pending;
+    size_t pending_count;
+    size_t pending_capacity;
+} Mixer;
+
+static void mixer_parameter_advance(mixer_parameter* parameter)
 {
-    // The flags "JackPortIsInput" and "JackPortIsOutput" are mutually exclusive.
-    return (PyObject*)PyBool_FromLong(port_is_output(self));
+    parameter->position++;
+    if(parameter->position >= parameter->duration) {
+        parameter->value = parameter->target;
+        parameter->duration = 0;
+        return;
+    }
+    float progress = (float)parameter->position / parameter->duration;
+    if(parameter->ramp == ramp_cosine) {
+        progress = 0.5f - 0.5f * cosf((float)M_PI * progress);
+    }
+    parameter->value = parameter->start + (parameter->target - parameter->start) * progress;
 }
 
-static PyObject* port_get_name(Port* self)
+static void mixer_apply(Mixer* mixer, const mixer_command* command)
 {
-    return (PyObject*)PyString_FromString(jack_port_name(self->port));
+    mixer_parameter* parameter = &mixer->parameters[command->parameter];
+    unsigned char ramping = parameter->duration > 0;
+    if(command->ramp == ramp_step || command->duration == 0) {
+        parameter->value = command->value;
+        parameter->target = command->value;
+        parameter->duration = 0;
+    } else {
+        parameter->start = parameter->value;
+        parameter->target = command->value;
+        parameter->ramp = command->ramp;
+        parameter->position = 0;
+        parameter->duration = command->duration;
+    }
+    // A new command replaces any ramp in progress.
+    if(!ramping && parameter->duration) {
+        mixer->ramps[mixer->ramp_count++] = command->parameter;
+    } else if(ramping && !parameter->duration) {
+        size_t ramp_index;
+        for(ramp_index = 0; mixer->ramps[ramp_index] != command->parameter; ramp_index++);
+        mixer->ramps[ramp_index] = mixer->ramps[--mixer->ramp_count];
+    }
 }
 
-static PyObject* port_get_short_name(Port* self)
+static void mixer_mix(Mixer* mixer, jack_nframes_t start, jack_nframes_t end)
 {
-    return (PyObject*)PyString_FromString(jack_port_short_name(self->port));
-}
+    float** inputs = mixer->buffers;
+    float** outputs = mixer->buffers + mixer->input_count;
+    const mixer_parameter* matrix = mixer->parameters;
+    const mixer_parameter* gains = matrix + mixer->output_count * mixer->input_count;
+    const mixer_parameter* mutes = gains + mixer->output_count;
+
+    size_t output_index, input_index;
+    jack_nframes_t frame;
+    if(!mixer->ramp_count) {
+        // All parameters are constant within this segment.
+        for(output_index = 0; output_index < mixer->output_count; output_index++) {
+            float* output = outputs[output_index];
+            memset(output + start, 0, (end - start) * sizeof(float));
+            float level = gains[output_index].value * mutes[output_index].value;
+            if(level == 0) {
+                continue;
+            }
+            for(input_index = 0; input_index < mixer->input_count; input_index++) {
+                float coefficient = matrix[output_index * mixer->input_count + input_index].value * level;
+                if(coefficient == 0) {
+                    continue;
+                }
+                const float* input = inputs[input_index];
+                for(frame = start; frame < end; frame++) {
+                    output[frame] += coefficient * input[frame];
+                }
+            }
+        }
+        return;
+    }
 
-static PyObject* port_get_type(Port* self)
-{
-    return (PyObject*)PyString_FromString(jack_port_type(self->port));
+    for(frame = start; frame < end; frame++) {
+        for(output_index = 0; output_index < mixer->output_count; output_index++) {
+            float sum = 0;
+            for(input_index = 0; input_index < mixer->input_count; input_index++) {
+                sum += matrix[output_index * mixer->input_count + input_index].value * inputs[input_index][frame];
+            }
+            outputs[output_index][frame] = sum * gains[output_index].value * mutes[output_index].value;
+        }
+        size_t ramp_index = 0;
+        while(ramp_index < mixer->ramp_count) {
+            mixer_parameter* parameter = &mixer->parameters[mixer->ramps[ramp_index]];
+            mixer_parameter_advance(parameter);
+            if(parameter->duration) {
+                ramp_index++;
+            } else {
+                mixer->ramps[ramp_index] = mixer->ramps[--mixer->ramp_count];
+            }
+        }
+    }
 }
 
-static PyObject* port_set_short_name(Port* self, PyObject* args)
+static void mixer_process(processor* p, jack_nframes_t nframes)
 {
-    const char* name;
-    if(!PyArg_ParseTuple(args, "s", &name)) {
-        return NULL;
+    Mixer* mixer = container_of(p, Mixer, mixer_processor);
+
+    // Frame offsets relative to the start of this cycle remain valid when the frame time wraps around.
+    jack_nframes_t cycle_start = jack_last_frame_time(mixer->client->client);
+
+    // Commands stay queued while too many are pending, so Python notices the queue filling up.
+    mixer_command command;
+    while(mixer->pending_count < mixer->pending_capacity
+            && jack_ringbuffer_read_space(mixer->queue) >= sizeof(mixer_command)) {
+        jack_ringbuffer_read(mixer->queue, (char*)&command, sizeof(mixer_command));
+        if(command.immediate) {
+            command.frame = cycle_start;
+        }
+        // Insertion sort, keeping commands with equal frames in submission order.
+        int32_t offset = (int32_t)(command.frame - cycle_start);
+        size_t index = mixer->pending_count;
+        while(index > 0 && (int32_t)(mixer->pending[index - 1].frame - cycle_start) <= offset) {
+            mixer->pending[index] = mixer->pending[index - 1];
+            index--;
+        }
+        mixer->pending[index] = command;
+        mixer->pending_count++;
     }
 
-    // 0 on success, otherwise a non-zero error code.
-    if(jack_port_set_name(self->port, name)) {
-        return NULL;
+    size_t port_index;
+    for(port_index = 0; port_index < mixer->input_count + mixer->output_count; port_index++) {
+        mixer->buffers[port_index] = (float*) jack_port_get_buffer(mixer->jack_ports[port_index], nframes);
     }
 
-    Py_INCREF(Py_None);
-    return Py_None;
+    // Split the cycle at the frames commands are scheduled for.
+    jack_nframes_t frame = 0;
+    while(frame < nframes) {
+        jack_nframes_t end = nframes;
+        while(mixer->pending_count) {
+            const mixer_command* next = &mixer->pending[mixer->pending_count - 1];
+            int32_t offset = (int32_t)(next->frame - cycle_start);
+            if(offset > (int32_t)frame) {
+                if(offset < (int32_t)nframes) {
+                    end = offset;
+                }
+                break;
+            }
+            mixer_apply(mixer, next);
+            mixer->pending_count--;
+        }
+        mixer_mix(mixer, frame, end);
+        frame = end;
+    }
 }
 
-static PyObject* port_get_client_name(Port* self)
+static int mixer_parse_ports(Mixer* mixer, PyObject* ports, unsigned long direction, size_t offset)
 {
-    // e.g. "PulseAudio JACK Sink:front-left"
-    const char* port_name = jack_port_name(self->port);
+    Py_ssize_t port_count = PyTuple_GET_SIZE(ports);
+    Py_ssize_t port_index;
+    for(port_index = 0; port_index < port_count; port_index++) {
+        PyObject* port = PyTuple_GET_ITEM(ports, port_index);
+        if(!PyObject_TypeCheck(port, &port_type)) {
+            PyErr_SetString(PyExc_TypeError, "Ports must be of type jack.Port.");
+            return -1;
+        }
+        jack_port_t* jack_port = ((Port*)port)->port;
+        if(!jack_port_is_mine(mixer->client->client, jack_port)
+                || !(jack_port_flags(jack_port) & direction)
+                || strcmp(jack_port_type(jack_port), JACK_DEFAULT_AUDIO_TYPE)) {
+            PyErr_SetString(PyExc_ValueError, "Expected audio input and output ports registered by the given client.");
+            return -1;
+        }
+        mixer->jack_ports[offset + port_index] = jack_port;
+    }
+    return 0;
+}
 
-    int client_name_length = strlen(port_name) - strlen(jack_port_short_name(self->port)) - 1;
+static PyObject* mixer___new__(PyTypeObject* type, PyObject* args, PyObject* kwargs)
+{
+    Mixer* self = (Mixer*)type->tp_alloc(type, 0);
 
-    // e.g. "PulseAudio JACK Sink"
-    char* client_name = (char*) malloc(jack_port_name_size());
-    strncpy(client_name, port_name, client_name_length);
-    client_name[client_name_length] = '\0';
-    PyObject* client_name_python = PyString_FromString(client_name);
-    free(client_name);
+    if(self) {
+        PyObject *client_python, *inputs, *outputs;
+        unsigned long queue_size = 1024;
+        static char* kwlist[] = {"client", "inputs", "outputs", "queue_size", NULL};
+        // The object’s reference count is not increased.
+        if(!PyArg_ParseTupleAndKeywords(
+                    args, kwargs, "O!OO|k", kwlist,
+                    &client_type, &client_python, &inputs, &outputs, &queue_size
+                    )) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        Py_INCREF(client_python);
+        self->client = (Client*)client_python;
 
-    return client_name_python;
+        self->inputs = PySequence_Tuple(inputs);
+        self->outputs = self->inputs ? PySequence_Tuple(outputs) : NULL;
+        if(!self->outputs) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        self->input_count = PyTuple_GET_SIZE(self->inputs);
+        self->output_count = PyTuple_GET_SIZE(self->outputs);
+        if(!queue_size) {
+            PyErr_SetString(PyExc_ValueError, "Queue size must not be zero.");
+            Py_DECREF(self);
+            return NULL;
+        }
+
+        size_t port_count = self->input_count + self->output_count;
+        self->parameter_count = self->output_count * self->input_count + 2 * self->output_count;
+        Client* client = self->client;
+        if(!(self->jack_ports = (jack_port_t**) client_allocate(client, port_count * sizeof(jack_port_t*)))
+                || !(self->buffers = (float**) client_allocate(client, port_count * sizeof(float*)))
+                || !(self->parameters = (mixer_parameter*) client_allocate(
+                        client, self->parameter_count * sizeof(mixer_parameter)))
+                || !(self->ramps = (unsigned int*) client_allocate(
+                        client, self->parameter_count * sizeof(unsigned int)))
+                || !(self->queue = client_ringbuffer_create(client, queue_size * sizeof(mixer_command)))
+                || !(self->pending = (mixer_command*) client_allocate(
+                        client, queue_size * sizeof(mixer_command)))) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        self->pending_capacity = queue_size;
+
+        if(mixer_parse_ports(self, self->inputs, JackPortIsInput, 0)
+                || mixer_parse_ports(self, self->outputs, JackPortIsOutput, self->input_count)) {
+            Py_DECREF(self);
+            return NULL;
+        }
+
+        // Route input n to output n, unity gain, not muted.
+        size_t parameter_index;
+        for(parameter_index = 0; parameter_index < self->parameter_count; parameter_index++) {
+            mixer_parameter* parameter = &self->parameters[parameter_index];
+            size_t matrix_size = self->output_count * self->input_count;
+            if(parameter_index < matrix_size) {
+                size_t output_index = parameter_index / self->input_count;
+                size_t input_index = parameter_index % self->input_count;
+                parameter->value = output_index == input_index ? 1 : 0;
+            } else {
+                parameter->value = 1;
+            }
+            parameter->target = parameter->value;
+        }
+
+        self->mixer_processor.process = mixer_process;
+        self->mixer_processor.name = "jack.Mixer";
+        if(client_attach_processor(self->client, &self->mixer_processor)) {
+            Py_DECREF(self);
+            return NULL;
+        }
+    }
+
+    return (PyObject*)self;
 }
 
-static PyObject* port_get_aliases(Port* self)
+static PyObject* mixer_schedule(Mixer* self, unsigned int parameter, float value, PyObject* frame, int ramp, unsigned long duration)
 {
-    PyObject* aliases_list = PyList_New(0);
-    if(!aliases_list) {
+    if(ramp != ramp_step && ramp != ramp_linear && ramp != ramp_cosine) {
+        PyErr_SetString(PyExc_ValueError, "Invalid ramp given.");
         return NULL;
     }
 
-    char* aliases[2];
-    aliases[0] = (char*) malloc(jack_port_name_size());
-    aliases[1] = (char*) malloc(jack_port_name_size());
-    int alias_count = jack_port_get_aliases(self->port, aliases);
-    int alias_index;
-    for(alias_index = 0; alias_index < alias_count; alias_index++) {
-        PyList_Append(aliases_list, PyString_FromString(aliases[alias_index]));
+    mixer_command command;
+    memset(&command, 0, sizeof(mixer_command));
+    command.parameter = parameter;
+    command.value = value;
+    command.ramp = ramp;
+    command.duration = duration;
+    if(!frame || frame == Py_None) {
+        command.immediate = 1;
+    } else {
+        // Frame times wrap around like jack_frame_time() does.
+        command.frame = (jack_nframes_t) PyInt_AsUnsignedLongMask(frame);
+        if(PyErr_Occurred()) {
+            return NULL;
+        }
     }
-    free(aliases[0]);
-    free(aliases[1]);
 
-    return aliases_list;
-}
+    // Python is the only writer, serialized by the GIL.
+    // The ring buffer is rounded up to a power of two, so limit it to the capacity of pending commands.
+    if(jack_ringbuffer_read_space(self->queue) >= self->pending_capacity * sizeof(mixer_command)
+            || jack_ringbuffer_write_space(self->queue) < sizeof(mixer_command)) {
+        PyErr_SetString(error, "Command queue is full.");
+        return NULL;
+    }
+    jack_ringbuffer_write(self->queue, (const char*)&command, sizeof(mixer_command));
 
-unsigned char port_is_physical(const Port* port)
-{
-    return jack_port_flags(port->port) & JackPortIsPhysical;
+    Py_INCREF(Py_None);
+    return Py_None;
 }
 
-unsigned char port_is_terminal(const Port* port)
+static PyObject* mixer_set_matrix(Mixer* self, PyObject* args, PyObject* kwargs)
 {
-    return jack_port_flags(port->port) & JackPortIsTerminal;
+    unsigned int output_index, input_index;
+    float value;
+    PyObject* frame = NULL;
+    int ramp = ramp_step;
+    unsigned long duration = 0;
+    static char* kwlist[] = {"output", "input", "value", "frame", "ramp", "duration", NULL};
+    if(!PyArg_ParseTupleAndKeywords(
+                args, kwargs, "IIf|Oik", kwlist,
+                &output_index, &input_index, &value, &frame, &ramp, &duration
+                )) {
+        return NULL;
+    }
+    if(output_index >= self->output_count || input_index >= self->input_count) {
+        PyErr_SetString(PyExc_IndexError, "Invalid input or output index given.");
+        return NULL;
+    }
+
+    return mixer_schedule(self, output_index * self->input_count + input_index, value, frame, ramp, duration);
 }
 
-static PyObject* port___repr__(Port* self)
+static PyObject* mixer_set_gain(Mixer* self, PyObject* args, PyObject* kwargs)
 {
-    static PyObject* format;
-    if(!format) {
-        format = PyString_FromString(
-                "jack.Port(name = '%s', type = '%s', direction = %s, physical = %s, terminal = %s)"
-                );
+    unsigned int output_index;
+    float value;
+    PyObject* frame = NULL;
+    int ramp = ramp_step;
+    unsigned long duration = 0;
+    static char* kwlist[] = {"output", "value", "frame", "ramp", "duration", NULL};
+    if(!PyArg_ParseTupleAndKeywords(
+                args, kwargs, "If|Oik", kwlist,
+                &output_index, &value, &frame, &ramp, &duration
+                )) {
+        return NULL;
     }
-    PyObject* args = Py_BuildValue(
-            "(s,s,s,s,s)",
-            jack_port_name(self->port),
-            jack_port_type(self->port),
-            port_is_input(self) ? "jack.Input" : (port_is_output(self) ? "jack.Output" : "?"),
-            port_is_physical(self) ? "True" : "False",
-            port_is_terminal(self) ? "True" : "False"
+    if(output_index >= self->output_count) {
+        PyErr_SetString(PyExc_IndexError, "Invalid output index given.");
+        return NULL;
+    }
+
+    return mixer_schedule(
+            self,
+            self->output_count * self->input_count + output_index,
+            value, frame, ramp, duration
             );
-    PyObject* repr = PyString_Format(format, args);
-    Py_DECREF(args);
-    return repr;
 }
 
-static unsigned char port_equal(const Port* port_a, const Port* port_b) 
+static PyObject* mixer_set_mute(Mixer* self, PyObject* args, PyObject* kwargs)
 {
-    // return jack_port_uuid(port_a->port) == jack_port_uuid(port_b->port);
-    return strcmp(jack_port_name(port_a->port), jack_port_name(port_b->port)) == 0;
+    unsigned int output_index;
+    unsigned char muted;
+    PyObject* frame = NULL;
+    int ramp = ramp_step;
+    unsigned long duration = 0;
+    static char* kwlist[] = {"output", "muted", "frame", "ramp", "duration", NULL};
+    if(!PyArg_ParseTupleAndKeywords(
+                args, kwargs, "Ib|Oik", kwlist,
+                &output_index, &muted, &frame, &ramp, &duration
+                )) {
+        return NULL;
+    }
+    if(output_index >= self->output_count) {
+        PyErr_SetString(PyExc_IndexError, "Invalid output index given.");
+        return NULL;
+    }
+
+    return mixer_schedule(
+            self,
+            self->output_count * self->input_count + self->output_count + output_index,
+            muted ? 0 : 1, frame, ramp, duration
+            );
 }
 
-static PyObject* port_richcompare(Port* port_a, Port* port_b, int operation)
+static void mixer_dealloc(Mixer* self)
 {
-    PyObject* result; 
-
-    switch(operation) {
-        case Py_EQ:
-            result = port_equal(port_a, port_b) ? Py_True : Py_False;
-            break;
-        case Py_NE:
-            result = !port_equal(port_a, port_b) ? Py_True : Py_False;
-            break;
-        default:
-            PyErr_SetString(PyExc_ValueError, "This operation is not available for jack ports.");
-            return NULL;
+    if(self->client) {
+        client_detach_processor(self->client, &self->mixer_processor);
+        client_release(self->client, self->jack_ports);
+        client_release(self->client, self->buffers);
+        client_release(self->client, self->parameters);
+        client_release(self->client, self->ramps);
+        client_release(self->client, self->queue);
+        client_release(self->client, self->pending);
     }
 
-    Py_INCREF(result);
-    return result;
-}
+    Py_XDECREF(self->client);
+    Py_XDECREF(self->inputs);
+    Py_XDECREF(self->outputs);
 
-static void port_dealloc(Port* self)
-{
     self->ob_type->tp_free((PyObject*)self);
 }
 
-static PyMethodDef port_methods[] = {
-    {
-        "is_input",
-        (PyCFunction)python_port_is_input,
-        METH_NOARGS,
-        "Return true if the port can receive data.",
-        },
+static PyMethodDef mixer_methods[] = {
     {
-        "is_output",
-        (PyCFunction)python_port_is_output,
-        METH_NOARGS,
-        "Return true if data can be read from the port.",
+        "set_matrix",
+        (PyCFunction)mixer_set_matrix,
+        METH_VARARGS | METH_KEYWORDS,
+        "Schedule a change of the level routed from an input to an output.",
         },
     {
-        "get_name",
-        (PyCFunction)port_get_name,
-        METH_NOARGS,
-        "Return port's name.",
+        "set_gain",
+        (PyCFunction)mixer_set_gain,
+        METH_VARARGS | METH_KEYWORDS,
+        "Schedule a change of an output's gain.",
         },
     {
-        "get_short_name",
-        (PyCFunction)port_get_short_name,
-        METH_NOARGS,
-        "Return port's name without the preceding name of the associated client.",
+        "set_mute",
+        (PyCFunction)mixer_set_mute,
+        METH_VARARGS | METH_KEYWORDS,
+        "Schedule muting or unmuting an output.",
         },
+    {NULL},
+    };
+
+static PyMethodDef module_methods[] = {
     {
-        "get_type",
-        (PyCFunction)port_get_type,
-        METH_NOARGS,
-        "Return port's type.",
+        "start_tracing",
+        (PyCFunction)python_start_tracing,
+        METH_VARARGS | METH_KEYWORDS,
+        "Start recording process cycles, callbacks and GIL waits of up to the given number of threads.",
         },
     {
-        "get_client_name",
-        (PyCFunction)port_get_client_name,
+        "stop_tracing",
+        (PyCFunction)python_stop_tracing,
         METH_NOARGS,
-        "Return the name of the associated client.",
+        "Stop recording. Recorded events are kept until tracing is started again.",
         },
     {
-        "set_short_name",
-        (PyCFunction)port_set_short_name,
+        "dump_trace",
+        (PyCFunction)python_dump_trace,
         METH_VARARGS,
-        "Modify a port's short name. May be called at any time.",
-        },
-    {
-        "get_aliases",
-        (PyCFunction)port_get_aliases,
-        METH_NOARGS,
-        "Return list of assigned aliases.",
+        "Write recorded events to a file in Chrome trace event format.",
         },
     {NULL},
     };
@@ -775,7 +3503,7 @@ PyMODINIT_FUNC initjack(void)
     // This must be done in the main thread before creating engaging in any thread operations.
     PyEval_InitThreads();
 
-    PyObject* module = Py_InitModule("jack", NULL);
+    PyObject* module = Py_InitModule("jack", module_methods);
     if(!module) {
         return;
     }
@@ -792,9 +3520,6 @@ PyMODINIT_FUNC initjack(void)
     Py_INCREF(connection_exists);
     PyModule_AddObject(module, "ConnectionExists", connection_exists);
 
-    static PyTypeObject client_type = {
-        PyObject_HEAD_INIT(NULL)
-        };
     client_type.tp_name = "jack.Client";
     client_type.tp_basicsize = sizeof(Client);
     client_type.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
@@ -822,9 +3547,78 @@ PyMODINIT_FUNC initjack(void)
     Py_INCREF(&port_type);
     PyModule_AddObject(module, "Port", (PyObject*)&port_type);
 
+    bridge_type.tp_name = "jack.Bridge";
+    bridge_type.tp_basicsize = sizeof(Bridge);
+    bridge_type.tp_flags = Py_TPFLAGS_DEFAULT;
+    bridge_type.tp_doc = "Move audio between ports of two clients, compensating for clock drift between their servers.";
+    bridge_type.tp_new = bridge___new__;
+    bridge_type.tp_dealloc = (destructor)bridge_dealloc;
+    bridge_type.tp_methods = bridge_methods;
+    if(PyType_Ready(&bridge_type) < 0) {
+        return;
+    }
+    Py_INCREF(&bridge_type);
+    PyModule_AddObject(module, "Bridge", (PyObject*)&bridge_type);
+
+    shared_memory_tap_type.tp_name = "jack.SharedMemoryTap";
+    shared_memory_tap_type.tp_basicsize = sizeof(SharedMemoryTap);
+    shared_memory_tap_type.tp_flags = Py_TPFLAGS_DEFAULT;
+    shared_memory_tap_type.tp_doc = "Copy ports into shared memory each cycle for local processes that are no JACK clients.";
+    shared_memory_tap_type.tp_new = shared_memory_tap___new__;
+    shared_memory_tap_type.tp_dealloc = (destructor)shared_memory_tap_dealloc;
+    shared_memory_tap_type.tp_methods = shared_memory_tap_methods;
+    if(PyType_Ready(&shared_memory_tap_type) < 0) {
+        return;
+    }
+    Py_INCREF(&shared_memory_tap_type);
+    PyModule_AddObject(module, "SharedMemoryTap", (PyObject*)&shared_memory_tap_type);
+
+    spectrum_analyzer_type.tp_name = "jack.SpectrumAnalyzer";
+    spectrum_analyzer_type.tp_basicsize = sizeof(SpectrumAnalyzer);
+    spectrum_analyzer_type.tp_flags = Py_TPFLAGS_DEFAULT;
+    spectrum_analyzer_type.tp_doc = "Compute windowed FFT magnitude spectra of an input port on a helper thread.";
+    spectrum_analyzer_type.tp_new = spectrum_analyzer___new__;
+    spectrum_analyzer_type.tp_dealloc = (destructor)spectrum_analyzer_dealloc;
+    spectrum_analyzer_type.tp_methods = spectrum_analyzer_methods;
+    if(PyType_Ready(&spectrum_analyzer_type) < 0) {
+        return;
+    }
+    Py_INCREF(&spectrum_analyzer_type);
+    PyModule_AddObject(module, "SpectrumAnalyzer", (PyObject*)&spectrum_analyzer_type);
+
+    oscillator_type.tp_name = "jack.Oscillator";
+    oscillator_type.tp_basicsize = sizeof(Oscillator);
+    oscillator_type.tp_flags = Py_TPFLAGS_DEFAULT;
+    oscillator_type.tp_doc = "Write a sine wave plus a constant offset to an output port, e.g. as test tone or DC reference.";
+    oscillator_type.tp_new = oscillator___new__;
+    oscillator_type.tp_dealloc = (destructor)oscillator_dealloc;
+    oscillator_type.tp_methods = oscillator_methods;
+    if(PyType_Ready(&oscillator_type) < 0) {
+        return;
+    }
+    Py_INCREF(&oscillator_type);
+    PyModule_AddObject(module, "Oscillator", (PyObject*)&oscillator_type);
+
+    mixer_type.tp_name = "jack.Mixer";
+    mixer_type.tp_basicsize = sizeof(Mixer);
+    mixer_type.tp_flags = Py_TPFLAGS_DEFAULT;
+    mixer_type.tp_doc = "Mix input into output ports, applying scheduled parameter changes sample accurately.";
+    mixer_type.tp_new = mixer___new__;
+    mixer_type.tp_dealloc = (destructor)mixer_dealloc;
+    mixer_type.tp_methods = mixer_methods;
+    if(PyType_Ready(&mixer_type) < 0) {
+        return;
+    }
+    Py_INCREF(&mixer_type);
+    PyModule_AddObject(module, "Mixer", (PyObject*)&mixer_type);
+
     PyModule_AddIntConstant(module, "Input", port_input);
     PyModule_AddIntConstant(module, "Output", port_output);
 
+    PyModule_AddIntConstant(module, "RampStep", ramp_step);
+    PyModule_AddIntConstant(module, "RampLinear", ramp_linear);
+    PyModule_AddIntConstant(module, "RampCosine", ramp_cosine);
+
     PyModule_AddStringConstant(module, "DefaultAudioPortType", JACK_DEFAULT_AUDIO_TYPE);
     PyModule_AddStringConstant(module, "DefaultMidiPortType", JACK_DEFAULT_MIDI_TYPE);
 }
@@ -16,7 +16,7 @@ setup(
         Extension(
             'jack', 
             sources = glob.glob('*.c'),
-            libraries = ['jack'],
+            libraries = ['jack', 'm'],
             ),
         ],
     tests_require = ['pytest', 'mock'],
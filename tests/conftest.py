@@ -0,0 +1,37 @@
+import pytest
+
+import jack
+
+import json
+import os
+import tempfile
+
+@pytest.fixture
+def register_port():
+    def register_port(client, direction = jack.Input, name = None):
+        return client.register_port(
+                name = name or ('in' if direction == jack.Input else 'out'),
+                type = jack.DefaultAudioPortType,
+                direction = direction,
+                )
+    return register_port
+
+@pytest.fixture
+def register_ports(register_port):
+    def register_ports(client, count, direction = jack.Input, prefix = None):
+        prefix = prefix or ('in' if direction == jack.Input else 'out')
+        return [register_port(client, direction, '%s %d' % (prefix, index)) for index in range(count)]
+    return register_ports
+
+@pytest.fixture
+def dump_trace():
+    def dump_trace():
+        trace_file, trace_path = tempfile.mkstemp(suffix = '.json')
+        os.close(trace_file)
+        try:
+            jack.dump_trace(trace_path)
+            with open(trace_path) as trace_file:
+                return json.load(trace_file)
+        finally:
+            os.remove(trace_path)
+    return dump_trace
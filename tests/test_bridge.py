@@ -0,0 +1,88 @@
+import pytest
+
+import jack
+
+import os
+import time
+
+@pytest.fixture
+def register_bridge_ports(register_port):
+    def register_bridge_ports(source_client, target_client):
+        return register_port(source_client, jack.Input, 'bridge in'), \
+            register_port(target_client, jack.Output, 'bridge out')
+    return register_bridge_ports
+
+def test_create(register_bridge_ports):
+    source_client = jack.Client('test source')
+    target_client = jack.Client('test target')
+    source_port, target_port = register_bridge_ports(source_client, target_client)
+    bridge = jack.Bridge(source_client, source_port, target_client, target_port, latency = 1024)
+    assert bridge.get_latency() == 1024
+    assert bridge.get_ratio() == 1.0
+    assert bridge.get_fill() == 0
+
+def test_invalid_direction(register_bridge_ports):
+    source_client = jack.Client('test source')
+    target_client = jack.Client('test target')
+    source_port, target_port = register_bridge_ports(source_client, target_client)
+    with pytest.raises(ValueError):
+        jack.Bridge(target_client, target_port, source_client, source_port)
+
+def test_foreign_port(register_bridge_ports):
+    source_client = jack.Client('test source')
+    target_client = jack.Client('test target')
+    source_port, target_port = register_bridge_ports(source_client, target_client)
+    with pytest.raises(ValueError):
+        jack.Bridge(target_client, source_port, target_client, target_port)
+
+def measure_fill(bridge, duration):
+    fills = []
+    for index in range(int(duration / 0.01)):
+        time.sleep(0.01)
+        fills.append(bridge.get_fill())
+    return sorted(fills)
+
+def test_transfer(register_bridge_ports):
+    source_client = jack.Client('test source')
+    target_client = jack.Client('test target')
+    source_port, target_port = register_bridge_ports(source_client, target_client)
+    bridge = jack.Bridge(source_client, source_port, target_client, target_port)
+    assert bridge.get_latency() > 2 * source_client.get_port_type_buffer_size(jack.DefaultAudioPortType) / 4
+    # Samples buffered before the target starts must neither count as overruns nor add latency.
+    source_client.activate()
+    time.sleep(0.5)
+    target_client.activate()
+    time.sleep(0.5)
+    fills = measure_fill(bridge, 0.5)
+    assert fills[0] > 0
+    assert fills[-1] < 2 * bridge.get_latency()
+    assert bridge.get_underruns() == 0
+    assert bridge.get_overruns() == 0
+
+@pytest.mark.skipif(
+        not os.environ.get('JACK_BRIDGE_SERVER'),
+        reason = 'second server name not set in $JACK_BRIDGE_SERVER',
+        )
+def test_transfer_between_servers(register_bridge_ports):
+    # Run the second server at a slightly different rate to simulate drift.
+    source_client = jack.Client('test source')
+    target_client = jack.Client('test target', server_name = os.environ['JACK_BRIDGE_SERVER'])
+    source_port, target_port = register_bridge_ports(source_client, target_client)
+    # Tolerate scheduling delays of test machines without real-time privileges.
+    latency = 4096
+    bridge = jack.Bridge(source_client, source_port, target_client, target_port, latency = latency)
+    source_client.activate()
+    time.sleep(1)
+    target_client.activate()
+    time.sleep(4)
+    # The fill level stays close to the latency once the controller has settled,
+    # apart from rare scheduling delays.
+    period = max(
+        source_client.get_port_type_buffer_size(jack.DefaultAudioPortType),
+        target_client.get_port_type_buffer_size(jack.DefaultAudioPortType),
+        ) / 4
+    fills = measure_fill(bridge, 2)
+    assert fills[len(fills) // 10] > latency - 2 * period
+    assert fills[len(fills) * 9 // 10] < latency + 2 * period
+    assert bridge.get_underruns() == 0
+    assert bridge.get_overruns() == 0
@@ -2,7 +2,10 @@ import pytest
 
 import jack
 
+import math
+import mmap
 import mock
+import struct
 import time
 
 def test_create():
@@ -22,6 +25,23 @@ def test_register_port():
             )
     assert port in client.get_ports()
 
+def test_get_port_type_buffer_size():
+    client = jack.Client('test')
+    # One float per frame of a period.
+    assert client.get_port_type_buffer_size(jack.DefaultAudioPortType) % 4 == 0
+    assert client.get_port_type_buffer_size(jack.DefaultAudioPortType) > 0
+
+def test_get_sample_rate():
+    client = jack.Client('test')
+    assert client.get_sample_rate() > 0
+
+def test_get_frame_time():
+    client = jack.Client('test')
+    client.activate()
+    frame_time = client.get_frame_time()
+    time.sleep(0.1)
+    assert client.get_frame_time() != frame_time
+
 def test_port_register_callback():
     client = jack.Client('test')
     port_registered = mock.Mock()
@@ -33,3 +53,172 @@ def test_port_register_callback():
     time.sleep(0.1)
     port_registered.assert_called_with(client, port)
     port_unregistered.assert_not_called()
+
+def test_set_worker_count():
+    client = jack.Client('test')
+    assert client.get_worker_count() == 0
+    client.set_worker_count(3)
+    assert client.get_worker_count() == 3
+    client.set_worker_count(0)
+    assert client.get_worker_count() == 0
+
+@pytest.fixture
+def create_mixer(register_ports):
+    def create_mixer(client, name, size):
+        mixer = jack.Mixer(
+                client,
+                register_ports(client, size, jack.Input, name + ' in'),
+                register_ports(client, size, jack.Output, name + ' out'),
+                queue_size = 2 * size * size,
+                )
+        # Keep every matrix entry ramping, so the mixer processes sample by sample.
+        for output in range(size):
+            for input in range(size):
+                mixer.set_matrix(output, input, 1.0, ramp = jack.RampLinear, duration = 2 ** 30)
+        return mixer
+    return create_mixer
+
+def test_workers_process_all(register_ports):
+    client = jack.Client('test')
+    taps = [jack.SharedMemoryTap(client, register_ports(client, 1, prefix = 'tap %d' % index))
+            for index in range(8)]
+    client.set_worker_count(2)
+    client.activate()
+    time.sleep(0.2)
+    client.deactivate()
+    # Taps write their position in the process cycle, so all of them must agree.
+    positions = set([struct.unpack_from('=Q', mmap.mmap(
+                tap.fileno(), tap.get_size(), mmap.MAP_SHARED, mmap.PROT_READ), 40)[0] for tap in taps])
+    assert len(positions) == 1
+    assert positions.pop() > 0
+
+def test_workers_self_connected(create_mixer, dump_trace):
+    client = jack.Client('test')
+    mixer = create_mixer(client, 'mixer', 8)
+    target = client.register_port('tap', jack.DefaultAudioPortType, jack.Input)
+    tap = jack.SharedMemoryTap(client, [target])
+    source = client.register_port('oscillator', jack.DefaultAudioPortType, jack.Output)
+    oscillator = jack.Oscillator(client, source, frequency = 1000)
+    client.set_worker_count(2)
+    client.activate()
+    client.connect(source, target)
+    time.sleep(0.1)
+    jack.start_tracing()
+    time.sleep(0.2)
+    jack.stop_tracing()
+    client.deactivate()
+    events = dump_trace()['traceEvents']
+    process_threads = set([event['tid'] for event in events if event['name'] == 'process'])
+    processor_threads = set([event['tid'] for event in events if event['name'].startswith('jack.')])
+    assert processor_threads == process_threads
+    memory = mmap.mmap(tap.fileno(), tap.get_size(), mmap.MAP_SHARED, mmap.PROT_READ)
+    capacity, data_offset, sequence, position = struct.unpack_from('=QQQQ', memory, 16)
+    samples = struct.unpack_from('=%df' % capacity, memory, data_offset)
+    memory.close()
+    # Reading the oscillator's port while it is written would break the sine.
+    factor = 2 * math.cos(2 * math.pi * 1000 / client.get_sample_rate())
+    for index in range(position - 4800, position - 1):
+        sample = samples[index % capacity]
+        previous = samples[(index - 1) % capacity]
+        following = samples[(index + 1) % capacity]
+        assert abs(previous + following - factor * sample) < 1e-4
+
+def test_workers_share_cycle(create_mixer, dump_trace):
+    client = jack.Client('test')
+    mixers = [create_mixer(client, 'mixer %d' % index, 8) for index in range(4)]
+    client.set_worker_count(2)
+    jack.start_tracing()
+    client.activate()
+    time.sleep(0.3)
+    client.deactivate()
+    jack.stop_tracing()
+    events = dump_trace()['traceEvents']
+    process_threads = set([event['tid'] for event in events if event['name'] == 'process'])
+    mixer_threads = set([event['tid'] for event in events if event['name'] == 'jack.Mixer'])
+    assert mixer_threads - process_threads
+
+def test_worker_fallback(create_mixer):
+    client = jack.Client('test')
+    # The first mixer keeps the process thread busy until a worker claimed the second one,
+    # which then takes longer than a quarter period.
+    mixers = [create_mixer(client, 'light', 8), create_mixer(client, 'heavy', 48)]
+    client.set_worker_count(1)
+    client.activate()
+    time.sleep(0.5)
+    client.deactivate()
+    assert client.get_worker_fallbacks() > 0
+
+def test_arena_usage():
+    client = jack.Client('test', arena_size = 1024 * 1024)
+    usage = client.get_arena_usage()
+    assert usage['size'] == 1024 * 1024
+    assert usage['used'] == 0
+    assert usage['allocations'] == 0
+    port = client.register_port('port', jack.DefaultAudioPortType, jack.Input)
+    analyzer = jack.SpectrumAnalyzer(client, port, size = 256)
+    usage = client.get_arena_usage()
+    assert usage['used'] > 0
+    # The analyzer's ring buffer and the client's list of processors
+    assert usage['allocations'] == 2
+    del analyzer
+    assert client.get_arena_usage()['used'] == 0
+
+def test_arena_exhausted():
+    client = jack.Client('test', arena_size = 4096)
+    port = client.register_port('port', jack.DefaultAudioPortType, jack.Input)
+    with pytest.raises(jack.Error):
+        jack.SpectrumAnalyzer(client, port, size = 4096)
+    assert client.get_arena_usage()['used'] == 0
+
+def test_arena_churn(register_ports):
+    client = jack.Client('test', arena_size = 1024 * 1024)
+    mixer = jack.Mixer(client, register_ports(client, 2, jack.Input), register_ports(client, 2, jack.Output))
+    port = client.register_port('port', jack.DefaultAudioPortType, jack.Input)
+    used = client.get_arena_usage()['used']
+    for index in range(100):
+        analyzer = jack.SpectrumAnalyzer(client, port, size = 4096)
+        del analyzer
+    assert client.get_arena_usage()['used'] == used
+
+def test_arena_merge_free_blocks():
+    client = jack.Client('test', arena_size = 1024 * 1024)
+    port = client.register_port('port', jack.DefaultAudioPortType, jack.Input)
+    analyzers = []
+    with pytest.raises(jack.Error):
+        while True:
+            analyzers.append(jack.SpectrumAnalyzer(client, port, size = 4096))
+    # Neither gap alone fits a ring buffer of twice the size.
+    del analyzers[1:3]
+    jack.SpectrumAnalyzer(client, port, size = 8192)
+
+def resident_memory():
+    with open('/proc/self/status') as status:
+        for line in status:
+            if line.startswith('VmRSS:'):
+                return int(line.split()[1]) * 1024
+
+def test_arena_worker_pool():
+    client = jack.Client('test')
+    client.set_worker_count(2)
+    assert client.get_arena_usage()['allocations'] == 2
+    client.set_worker_count(0)
+    assert client.get_arena_usage()['used'] == 0
+
+def test_arena_untouched():
+    resident = resident_memory()
+    clients = [jack.Client('test') for index in range(4)]
+    for client in clients:
+        client.activate()
+    # Clients without buffers for the process thread fault in none of their arena.
+    assert resident_memory() - resident < 4 * 1024 * 1024
+    assert clients[0].get_arena_usage()['used'] == 0
+
+def test_arena_huge_pages():
+    client = jack.Client('test', arena_size = 1, huge_pages = True)
+    # Falls back to regular pages if no huge pages are reserved.
+    assert client.get_arena_usage()['size'] == 2 * 1024 * 1024
+    client.activate()
+    port = client.register_port('port', jack.DefaultAudioPortType, jack.Input)
+    analyzer = jack.SpectrumAnalyzer(client, port)
+    time.sleep(0.1)
+    assert analyzer.get_overruns() == 0
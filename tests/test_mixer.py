@@ -0,0 +1,122 @@
+import pytest
+
+import jack
+
+import math
+import mmap
+import struct
+import time
+
+@pytest.fixture
+def create_mixer(register_ports):
+    def create_mixer(client, input_count = 2, output_count = 2, **kwargs):
+        inputs = register_ports(client, input_count, jack.Input)
+        outputs = register_ports(client, output_count, jack.Output)
+        return jack.Mixer(client, inputs, outputs, **kwargs)
+    return create_mixer
+
+def test_create(create_mixer):
+    client = jack.Client('test')
+    mixer = create_mixer(client)
+
+def test_swapped_ports():
+    client = jack.Client('test')
+    port = client.register_port('out', jack.DefaultAudioPortType, jack.Output)
+    with pytest.raises(ValueError):
+        jack.Mixer(client, [port], [])
+
+def test_schedule(create_mixer):
+    client = jack.Client('test')
+    mixer = create_mixer(client)
+    frame = client.get_frame_time() + 4800
+    mixer.set_gain(0, 0.5, frame = frame, ramp = jack.RampLinear, duration = 480)
+    mixer.set_mute(1, True, frame = frame, ramp = jack.RampCosine, duration = 64)
+    mixer.set_matrix(1, 0, 1.0)
+    client.activate()
+    time.sleep(0.2)
+
+def read_tap(tap):
+    memory = mmap.mmap(tap.fileno(), tap.get_size(), mmap.MAP_SHARED, mmap.PROT_READ)
+    channel_count, sample_rate, capacity, data_offset, sequence, position \
+        = struct.unpack_from('=IIQQQQ', memory, 8)
+    assert position <= capacity
+    channels = [struct.unpack_from('=%df' % position, memory, data_offset + channel_index * capacity * 4)
+                for channel_index in range(channel_count)]
+    memory.close()
+    return channels
+
+def test_schedule_sample_accurate(register_port, register_ports):
+    client = jack.Client('test')
+    source = register_port(client, jack.Output, 'dc')
+    oscillator = jack.Oscillator(client, source, amplitude = 0, offset = 1)
+    mixer_input = register_port(client)
+    mixer_outputs = register_ports(client, 2, jack.Output)
+    mixer = jack.Mixer(client, [mixer_input], mixer_outputs)
+    mixer.set_matrix(1, 0, 1.0)
+    mixer.set_gain(0, 0.0)
+    mixer.set_gain(1, 0.0)
+    tap_client = jack.Client('tap')
+    tap_inputs = register_ports(tap_client, 2)
+    tap = jack.SharedMemoryTap(tap_client, tap_inputs, capacity = 4 * tap_client.get_sample_rate())
+    client.activate()
+    tap_client.activate()
+    client.connect(source, mixer_input)
+    for output, tap_input in zip(mixer_outputs, tap_inputs):
+        client.connect(output, tap_input)
+
+    time.sleep(0.1)
+    buffer_size = client.get_port_type_buffer_size(jack.DefaultAudioPortType) / 4
+    linear_frame = client.get_frame_time() + client.get_sample_rate() / 10 + buffer_size / 3
+    cosine_frame = linear_frame + 1000
+    duration = 480
+    mixer.set_gain(0, 1.0, frame = linear_frame, ramp = jack.RampLinear, duration = duration)
+    mixer.set_gain(1, 1.0, frame = cosine_frame, ramp = jack.RampCosine, duration = duration)
+    time.sleep(0.3)
+    linear, cosine = read_tap(tap)
+
+    # The tap starts at a cycle boundary and cycles start at multiples of the buffer size,
+    # but the tap may lag the mixer by whole cycles, depending on the server's process order.
+    linear_start = [sample != 0 for sample in linear].index(True) - 1
+    cosine_start = [sample != 0 for sample in cosine].index(True) - 1
+    assert linear_start % buffer_size == linear_frame % buffer_size
+    assert cosine_start - linear_start == cosine_frame - linear_frame
+    # A ramp starts from the current value at the scheduled frame.
+    for offset in range(0, duration + 10, 60):
+        progress = min(offset, duration) / float(duration)
+        assert abs(linear[linear_start + offset] - progress) < 1e-5
+        assert abs(cosine[cosine_start + offset] - (0.5 - 0.5 * math.cos(math.pi * progress))) < 1e-5
+
+def test_invalid_index(create_mixer):
+    client = jack.Client('test')
+    mixer = create_mixer(client, 2, 1)
+    with pytest.raises(IndexError):
+        mixer.set_gain(1, 0.5)
+    with pytest.raises(IndexError):
+        mixer.set_matrix(0, 2, 0.5)
+
+def test_invalid_ramp(create_mixer):
+    client = jack.Client('test')
+    mixer = create_mixer(client)
+    with pytest.raises(ValueError):
+        mixer.set_gain(0, 0.5, ramp = 42, duration = 64)
+
+def test_queue_full(create_mixer):
+    client = jack.Client('test')
+    mixer = create_mixer(client, queue_size = 4)
+    with pytest.raises(jack.Error):
+        for index in range(64):
+            mixer.set_gain(0, 0.5)
+
+def test_queue_full_pending(create_mixer):
+    client = jack.Client('test')
+    mixer = create_mixer(client, queue_size = 4)
+    client.activate()
+    frame = client.get_frame_time() + 10 * client.get_sample_rate()
+    # The process thread takes the first commands, the others wait in the queue.
+    for index in range(4):
+        mixer.set_gain(0, 0.5, frame = frame)
+    time.sleep(0.1)
+    for index in range(4):
+        mixer.set_gain(0, 0.5, frame = frame)
+    with pytest.raises(jack.Error):
+        mixer.set_gain(0, 0.5, frame = frame)
@@ -0,0 +1,64 @@
+import pytest
+
+import jack
+
+import mmap
+import struct
+import time
+
+def test_create(register_port):
+    client = jack.Client('test')
+    oscillator = jack.Oscillator(client, register_port(client, jack.Output), frequency = 440)
+    assert oscillator.get_frequency() == 440
+
+def test_set_parameters(register_port):
+    client = jack.Client('test')
+    oscillator = jack.Oscillator(client, register_port(client, jack.Output))
+    oscillator.set_frequency(220)
+    oscillator.set_amplitude(0.5)
+    oscillator.set_offset(-0.25)
+    assert oscillator.get_frequency() == 220
+    assert oscillator.get_amplitude() == 0.5
+    assert oscillator.get_offset() == -0.25
+
+def test_input_port(register_port):
+    client = jack.Client('test')
+    with pytest.raises(ValueError):
+        jack.Oscillator(client, register_port(client))
+
+def test_foreign_port(register_port):
+    client = jack.Client('test')
+    other_client = jack.Client('test')
+    with pytest.raises(ValueError):
+        jack.Oscillator(client, register_port(other_client, jack.Output))
+
+def test_offset(register_port):
+    client = jack.Client('test')
+    source = register_port(client, jack.Output)
+    oscillator = jack.Oscillator(client, source, amplitude = 0, offset = 0.25)
+    target = client.register_port('tap', jack.DefaultAudioPortType, jack.Input)
+    tap = jack.SharedMemoryTap(client, [target])
+    client.activate()
+    client.connect(source, target)
+    time.sleep(0.2)
+    memory = mmap.mmap(tap.fileno(), tap.get_size(), mmap.MAP_SHARED, mmap.PROT_READ)
+    capacity, data_offset, sequence, position = struct.unpack_from('=QQQQ', memory, 16)
+    samples = struct.unpack_from('=%df' % capacity, memory, data_offset)
+    memory.close()
+    assert samples[(position - 1) % capacity] == 0.25
+
+def test_set_offset(register_port):
+    client = jack.Client('test')
+    source = register_port(client, jack.Output)
+    oscillator = jack.Oscillator(client, source, amplitude = 0)
+    target = client.register_port('tap', jack.DefaultAudioPortType, jack.Input)
+    tap = jack.SharedMemoryTap(client, [target])
+    client.activate()
+    client.connect(source, target)
+    oscillator.set_offset(-0.5)
+    time.sleep(0.2)
+    memory = mmap.mmap(tap.fileno(), tap.get_size(), mmap.MAP_SHARED, mmap.PROT_READ)
+    capacity, data_offset, sequence, position = struct.unpack_from('=QQQQ', memory, 16)
+    samples = struct.unpack_from('=%df' % capacity, memory, data_offset)
+    memory.close()
+    assert samples[(position - 1) % capacity] == -0.5
@@ -0,0 +1,55 @@
+import pytest
+
+import jack
+
+import mmap
+import struct
+import time
+
+header_format = '=IIIIQQQQ'
+
+def read_header(tap):
+    memory = mmap.mmap(tap.fileno(), tap.get_size(), mmap.MAP_SHARED, mmap.PROT_READ)
+    header = struct.unpack_from(header_format, memory)
+    memory.close()
+    return header
+
+def test_create(register_ports):
+    client = jack.Client('test')
+    ports = register_ports(client, 2)
+    tap = jack.SharedMemoryTap(client, ports, capacity = 8192)
+    assert tap.get_capacity() == 8192
+    assert tap.get_ports() == ports
+    assert tap.get_size() >= 2 * 8192 * 4
+
+def test_header(register_ports):
+    client = jack.Client('test')
+    tap = jack.SharedMemoryTap(client, register_ports(client, 3), capacity = 8192)
+    magic, version, channel_count, sample_rate, capacity, data_offset, sequence, position \
+        = read_header(tap)
+    assert magic == 0x5054434a
+    assert version == 1
+    assert channel_count == 3
+    assert capacity == 8192
+    assert data_offset + channel_count * capacity * 4 == tap.get_size()
+    assert position == 0
+
+def test_foreign_port(register_ports):
+    client = jack.Client('test')
+    other_client = jack.Client('test')
+    with pytest.raises(ValueError):
+        jack.SharedMemoryTap(client, register_ports(other_client, 1))
+
+def test_no_ports():
+    client = jack.Client('test')
+    with pytest.raises(ValueError):
+        jack.SharedMemoryTap(client, [])
+
+def test_write(register_ports):
+    client = jack.Client('test')
+    tap = jack.SharedMemoryTap(client, register_ports(client, 1))
+    client.activate()
+    time.sleep(0.2)
+    sequence, position = read_header(tap)[6:]
+    assert sequence % 2 == 0
+    assert position > 0
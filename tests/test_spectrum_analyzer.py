@@ -0,0 +1,72 @@
+import pytest
+
+import jack
+
+import time
+
+def test_create(register_port):
+    client = jack.Client('test')
+    analyzer = jack.SpectrumAnalyzer(client, register_port(client), size = 2048, overlap = 0.75)
+    assert analyzer.get_size() == 2048
+    assert analyzer.get_hop() == 512
+    assert analyzer.get_spectrum() is None
+
+def test_invalid_size(register_port):
+    client = jack.Client('test')
+    with pytest.raises(ValueError):
+        jack.SpectrumAnalyzer(client, register_port(client), size = 1000)
+
+def test_invalid_overlap(register_port):
+    client = jack.Client('test')
+    with pytest.raises(ValueError):
+        jack.SpectrumAnalyzer(client, register_port(client), overlap = 1)
+
+def test_output_port(register_port):
+    client = jack.Client('test')
+    with pytest.raises(ValueError):
+        jack.SpectrumAnalyzer(client, register_port(client, jack.Output))
+
+def test_silence(register_port):
+    client = jack.Client('test')
+    analyzer = jack.SpectrumAnalyzer(client, register_port(client), size = 256)
+    client.activate()
+    time.sleep(0.2)
+    assert analyzer.get_spectrum_count() > 0
+    spectrum = analyzer.get_spectrum()
+    assert len(spectrum) == 256 / 2 + 1
+    assert max(spectrum) == 0
+
+@pytest.fixture
+def analyze_oscillator(register_port):
+    def analyze_oscillator(client, size, **kwargs):
+        port = register_port(client)
+        analyzer = jack.SpectrumAnalyzer(client, port, size = size, overlap = 0)
+        source = register_port(client, jack.Output)
+        oscillator = jack.Oscillator(client, source, **kwargs)
+        client.activate()
+        client.connect(source, port)
+        # Skip spectra of the transient after connecting.
+        time.sleep(0.1)
+        count = analyzer.get_spectrum_count()
+        while analyzer.get_spectrum_count() < count + 2:
+            time.sleep(0.01)
+        return analyzer.get_spectrum()
+    return analyze_oscillator
+
+def test_dc(analyze_oscillator):
+    spectrum = analyze_oscillator(jack.Client('test'), 256, amplitude = 0, offset = 1)
+    assert abs(spectrum[0] - 1) < 1e-3
+    # The Hann window leaks DC into the first bin only.
+    assert abs(spectrum[1] - 1) < 1e-3
+    assert max(spectrum[2:]) < 1e-3
+
+def test_sine(analyze_oscillator):
+    client = jack.Client('test')
+    size = 256
+    bin_index = 16
+    frequency = bin_index * client.get_sample_rate() / float(size)
+    spectrum = analyze_oscillator(client, size, frequency = frequency, amplitude = 0.5)
+    assert abs(spectrum[bin_index] - 0.5) < 1e-3
+    assert abs(spectrum[bin_index - 1] - 0.25) < 1e-3
+    assert abs(spectrum[bin_index + 1] - 0.25) < 1e-3
+    assert max(spectrum[:bin_index - 1] + spectrum[bin_index + 2:]) < 1e-3
@@ -0,0 +1,77 @@
+import pytest
+
+import jack
+
+import mock
+import time
+
+def test_trace(dump_trace):
+    jack.start_tracing()
+    client = jack.Client('test')
+    client.set_port_registered_callback(mock.Mock())
+    analyzer = jack.SpectrumAnalyzer(client, client.register_port('in', jack.DefaultAudioPortType, jack.Input))
+    client.activate()
+    client.register_port('port', jack.DefaultAudioPortType, jack.Output)
+    time.sleep(0.2)
+    jack.stop_tracing()
+    names = set([event['name'] for event in dump_trace()['traceEvents']])
+    assert 'process' in names
+    assert 'jack.SpectrumAnalyzer' in names
+    assert 'jack_registration_callback' in names
+    assert 'GIL wait' in names
+    assert 'Python callback' in names
+
+def test_stop_tracing(dump_trace):
+    jack.start_tracing()
+    jack.stop_tracing()
+    client = jack.Client('test')
+    client.activate()
+    time.sleep(0.1)
+    assert dump_trace()['traceEvents'] == []
+
+def test_spans_balanced(dump_trace):
+    jack.start_tracing()
+    client = jack.Client('test')
+    client.activate()
+    time.sleep(0.1)
+    client.deactivate()
+    jack.stop_tracing()
+    depth = {}
+    for event in dump_trace()['traceEvents']:
+        depth[event['tid']] = depth.get(event['tid'], 0) + (1 if event['ph'] == 'B' else -1)
+        assert depth[event['tid']] >= 0
+    assert set(depth.values()) == set([0])
+
+def test_capacity_exceeded():
+    jack.start_tracing()
+    with pytest.raises(jack.Error):
+        jack.start_tracing(events_per_thread = 2 ** 40)
+    jack.stop_tracing()
+
+def test_size_overflow():
+    with pytest.raises(ValueError):
+        jack.start_tracing(events_per_thread = 2 ** 64 // 24 + 1)
+    with pytest.raises(ValueError):
+        jack.start_tracing(events_per_thread = 0)
+
+def test_thread_limit_exceeded():
+    jack.start_tracing()
+    with pytest.raises(jack.Error):
+        jack.start_tracing(threads = 2 ** 20)
+    jack.stop_tracing()
+
+def test_restart_while_processing(dump_trace):
+    client = jack.Client('test')
+    analyzer = jack.SpectrumAnalyzer(client, client.register_port('in', jack.DefaultAudioPortType, jack.Input))
+    client.activate()
+    for index in range(200):
+        jack.start_tracing()
+    time.sleep(0.1)
+    client.deactivate()
+    jack.stop_tracing()
+    # Each buffer holds the events of a single thread and session only.
+    timestamps = {}
+    for event in dump_trace()['traceEvents']:
+        assert event['ts'] >= timestamps.get(event['tid'], 0)
+        timestamps[event['tid']] = event['ts']
+    assert timestamps